@@ -0,0 +1,16 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+// read_notion_blocks(page_or_database): the content of pages as one row per block
+class NotionBlocks {
+public:
+    // Block lists requested concurrently by a crawl
+    static constexpr idx_t DEFAULT_CONCURRENCY = 8;
+
+    static void RegisterTableFunction(DatabaseInstance &db);
+};
+
+} // namespace duckdb
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/catalog/catalog_entry/schema_catalog_entry.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/storage/storage_extension.hpp"
+#include "duckdb/transaction/transaction.hpp"
+#include "duckdb/transaction/transaction_manager.hpp"
+#include "notion_schema.hpp"
+#include <chrono>
+#include <mutex>
+#include <string>
+
+namespace duckdb {
+
+// A database of an attached workspace, scanned through read_notion
+class NotionTableEntry : public TableCatalogEntry {
+public:
+    NotionTableEntry(Catalog &catalog, SchemaCatalogEntry &schema, CreateTableInfo &info, std::string database_id,
+                     vector<NotionColumn> columns);
+
+    unique_ptr<BaseStatistics> GetStatistics(ClientContext &context, column_t column_id) override;
+    TableFunction GetScanFunction(ClientContext &context, unique_ptr<FunctionData> &bind_data) override;
+    TableStorageInfo GetStorageInfo(ClientContext &context) override;
+
+private:
+    std::string database_id;
+    vector<NotionColumn> columns;
+};
+
+// The only schema ("main") of an attached workspace. The databases shared with the integration
+// are listed by the first lookup, and the columns of a table are requested when it is first used
+// (unless the listing already included them). Both are kept until the workspace is detached; a
+// name that is not found lists the databases again once the listing is older than
+// notion_schema_cache_ttl, so databases shared later show up.
+class NotionSchemaEntry : public SchemaCatalogEntry {
+public:
+    NotionSchemaEntry(Catalog &catalog, CreateSchemaInfo &info);
+
+    void Scan(ClientContext &context, CatalogType type, const std::function<void(CatalogEntry &)> &callback) override;
+    void Scan(CatalogType type, const std::function<void(CatalogEntry &)> &callback) override;
+    optional_ptr<CatalogEntry> GetEntry(CatalogTransaction transaction, CatalogType type, const string &name) override;
+
+    // A workspace is read-only: these all throw
+    optional_ptr<CatalogEntry> CreateIndex(CatalogTransaction transaction, CreateIndexInfo &info,
+                                           TableCatalogEntry &table) override;
+    optional_ptr<CatalogEntry> CreateFunction(CatalogTransaction transaction, CreateFunctionInfo &info) override;
+    optional_ptr<CatalogEntry> CreateTable(CatalogTransaction transaction, BoundCreateTableInfo &info) override;
+    optional_ptr<CatalogEntry> CreateView(CatalogTransaction transaction, CreateViewInfo &info) override;
+    optional_ptr<CatalogEntry> CreateSequence(CatalogTransaction transaction, CreateSequenceInfo &info) override;
+    optional_ptr<CatalogEntry> CreateTableFunction(CatalogTransaction transaction,
+                                                   CreateTableFunctionInfo &info) override;
+    optional_ptr<CatalogEntry> CreateCopyFunction(CatalogTransaction transaction,
+                                                  CreateCopyFunctionInfo &info) override;
+    optional_ptr<CatalogEntry> CreatePragmaFunction(CatalogTransaction transaction,
+                                                    CreatePragmaFunctionInfo &info) override;
+    optional_ptr<CatalogEntry> CreateCollation(CatalogTransaction transaction, CreateCollationInfo &info) override;
+    optional_ptr<CatalogEntry> CreateType(CatalogTransaction transaction, CreateTypeInfo &info) override;
+    void DropEntry(ClientContext &context, DropInfo &info) override;
+    void Alter(CatalogTransaction transaction, AlterInfo &info) override;
+
+private:
+    // A database of the workspace; entry is created once its columns are known
+    struct NotionTableInfo {
+        std::string database_id;
+        vector<NotionColumn> columns;
+        unique_ptr<NotionTableEntry> entry;
+    };
+
+    // Lists the databases unless they were listed before; with refresh, also when the listing is stale
+    void ListTables(ClientContext &context, bool refresh = false);
+    void AddTable(const std::string &title, const std::string &database_id, vector<NotionColumn> columns);
+    // Creates the entries of the given tables, requesting the missing schemas concurrently
+    void LoadTables(ClientContext &context, const vector<std::string> &names);
+
+    std::mutex lock;
+    bool listed = false;
+    std::chrono::steady_clock::time_point listed_at;
+    case_insensitive_map_t<NotionTableInfo> tables;
+};
+
+// ATTACH '' AS workspace (TYPE notion): the databases shared with the integration as tables
+class NotionCatalog : public Catalog {
+public:
+    NotionCatalog(AttachedDatabase &db, std::string path);
+
+    void Initialize(bool load_builtin) override;
+    string GetCatalogType() override {
+        return "notion";
+    }
+
+    void ScanSchemas(ClientContext &context, std::function<void(SchemaCatalogEntry &)> callback) override;
+    optional_ptr<SchemaCatalogEntry> GetSchema(CatalogTransaction transaction, const string &schema_name,
+                                               OnEntryNotFound if_not_found,
+                                               QueryErrorContext error_context = QueryErrorContext()) override;
+
+    // A workspace is read-only: these all throw
+    optional_ptr<CatalogEntry> CreateSchema(CatalogTransaction transaction, CreateSchemaInfo &info) override;
+    unique_ptr<PhysicalOperator> PlanCreateTableAs(ClientContext &context, LogicalCreateTable &op,
+                                                   unique_ptr<PhysicalOperator> plan) override;
+    unique_ptr<PhysicalOperator> PlanInsert(ClientContext &context, LogicalInsert &op,
+                                            unique_ptr<PhysicalOperator> plan) override;
+    unique_ptr<PhysicalOperator> PlanDelete(ClientContext &context, LogicalDelete &op,
+                                            unique_ptr<PhysicalOperator> plan) override;
+    unique_ptr<PhysicalOperator> PlanUpdate(ClientContext &context, LogicalUpdate &op,
+                                            unique_ptr<PhysicalOperator> plan) override;
+    unique_ptr<LogicalOperator> BindCreateIndex(Binder &binder, CreateStatement &stmt, TableCatalogEntry &table,
+                                                unique_ptr<LogicalOperator> plan) override;
+
+    DatabaseSize GetDatabaseSize(ClientContext &context) override;
+    bool InMemory() override {
+        return false;
+    }
+    string GetDBPath() override {
+        return path;
+    }
+
+private:
+    void DropSchema(ClientContext &context, DropInfo &info) override;
+
+    std::string path;
+    unique_ptr<NotionSchemaEntry> main_schema;
+};
+
+// Notion has no transactions; reads always see the current state of the workspace
+class NotionTransaction : public Transaction {
+public:
+    NotionTransaction(TransactionManager &manager, ClientContext &context) : Transaction(manager, context) {
+    }
+};
+
+class NotionTransactionManager : public TransactionManager {
+public:
+    explicit NotionTransactionManager(AttachedDatabase &db) : TransactionManager(db) {
+    }
+
+    Transaction &StartTransaction(ClientContext &context) override;
+    ErrorData CommitTransaction(ClientContext &context, Transaction &transaction) override;
+    void RollbackTransaction(Transaction &transaction) override;
+    void Checkpoint(ClientContext &context, bool force = false) override;
+
+private:
+    std::mutex lock;
+    std::unordered_map<Transaction *, unique_ptr<Transaction>> transactions;
+};
+
+class NotionStorageExtension : public StorageExtension {
+public:
+    NotionStorageExtension();
+};
+
+} // namespace duckdb
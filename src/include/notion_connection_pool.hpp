@@ -0,0 +1,68 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include <openssl/ssl.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace duckdb {
+
+// A single keep-alive connection to a Notion API host
+struct NotionConnection {
+    ~NotionConnection();
+
+    // Host name with an optional ":port"
+    std::string host;
+    // False for plain HTTP connections (e.g. to a local stand-in server), which have no ssl
+    bool secure = true;
+    // Blocking connections are driven through a BIO (which owns ssl); connections of the event
+    // loop are a non-blocking socket with ssl attached to it
+    BIO *bio = nullptr;
+    SSL *ssl = nullptr;
+    int fd = -1;
+    // True when this connection already served a request (it may have been closed by the server since)
+    bool reused = false;
+    std::chrono::steady_clock::time_point last_used;
+};
+
+// Process-wide pool of idle HTTPS connections shared by all NotionRequests calls.
+// Keeps one SSL_CTX for the lifetime of the extension, remembers TLS sessions per
+// host for resumption and evicts connections that have been idle for too long.
+class NotionConnectionPool {
+public:
+    static constexpr idx_t DEFAULT_POOL_SIZE = 8;
+    static constexpr idx_t DEFAULT_IDLE_TIMEOUT_SECONDS = 30;
+
+    static void Initialize();
+    static NotionConnectionPool &Get();
+
+    // Settings callbacks for notion_pool_size and notion_pool_idle_timeout
+    static void SetPoolSize(ClientContext &context, SetScope scope, Value &parameter);
+    static void SetIdleTimeout(ClientContext &context, SetScope scope, Value &parameter);
+
+    // Returns an idle connection to host, or opens a new one. Returns nullptr and sets error on failure.
+    unique_ptr<NotionConnection> Acquire(const std::string &host, bool secure, std::string &error);
+    // Returns an idle connection to host of the given kind (BIO or non-blocking socket), or nullptr
+    unique_ptr<NotionConnection> AcquireIdle(const std::string &host, bool secure, bool nonblocking);
+    // Creates the SSL object of a new non-blocking connection to host, resuming its last session
+    SSL *NewSsl(const std::string &host);
+    // Hands a connection back; it is kept for reuse only if reusable is set and the pool has room
+    void Release(unique_ptr<NotionConnection> connection, bool reusable);
+
+private:
+    NotionConnectionPool();
+
+    unique_ptr<NotionConnection> Connect(const std::string &host, bool secure, std::string &error);
+    void EvictIdle();
+
+    std::mutex lock;
+    SSL_CTX *ctx;
+    idx_t max_idle_connections = DEFAULT_POOL_SIZE;
+    std::chrono::seconds idle_timeout {DEFAULT_IDLE_TIMEOUT_SECONDS};
+    vector<unique_ptr<NotionConnection>> idle_connections;
+    std::unordered_map<std::string, SSL_SESSION *> sessions;
+};
+
+} // namespace duckdb
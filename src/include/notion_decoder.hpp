@@ -0,0 +1,60 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "notion_json.hpp"
+#include "notion_schema.hpp"
+#include <string>
+#include <unordered_map>
+
+namespace duckdb {
+
+// Decodes Notion page objects straight into the flat vectors of a DataChunk.
+// Each page is walked once; members that do not map to an output column are skipped.
+// Values are written in the type of the output vector, e.g. options as ENUM codes or as text.
+class NotionPageDecoder {
+public:
+    // Output vector i receives columns[column_ids[i]]
+    NotionPageDecoder(const vector<NotionColumn> &columns, const vector<idx_t> &column_ids);
+
+    void Decode(const char *data, idx_t size, DataChunk &output, idx_t row);
+
+    // Reads people by id, as they are written, rather than by name
+    void ReadPeopleIds() {
+        people_ids = true;
+    }
+
+    // True when an option missing from its ENUM was read as NULL since the last call. Options
+    // added or renamed after the schema was read have no code until the schema is read again.
+    bool TakeUnknownOptions() {
+        auto result = unknown_options;
+        unknown_options = false;
+        return result;
+    }
+
+    // Appends the plain_text of every element of a rich text array; returns false for an empty array
+    static bool ReadRichText(NotionJsonCursor &cursor, std::string &result);
+
+private:
+    void DecodeValue(NotionJsonCursor &cursor, NotionPropertyType type, Vector &vector, idx_t row);
+    void DecodeProperty(NotionJsonCursor &cursor, NotionPropertyType type, Vector &vector, idx_t row);
+    void WriteString(Vector &vector, idx_t row, const NotionJsonString &text);
+    void WriteTimestamp(Vector &vector, idx_t row, const NotionJsonString &text);
+    // Writes the dictionary code of an option to a select, status or multi-select ENUM vector;
+    // returns false, leaving the row NULL, for an option that is not in the ENUM
+    bool WriteEnum(Vector &vector, idx_t row, const NotionJsonString &text);
+    void AppendListString(Vector &vector, idx_t row, const NotionJsonString &text);
+
+    vector<NotionPropertyType> types;
+    bool people_ids = false;
+    bool unknown_options = false;
+    // Output vector index by page member name and by property name
+    std::unordered_map<std::string, idx_t> page_fields;
+    std::unordered_map<std::string, idx_t> properties;
+    // The page being decoded, for slicing raw JSON values out of it
+    const char *page_data = nullptr;
+    // Scratch buffers reused across pages
+    std::string key_buffer;
+    std::string text_buffer;
+};
+
+} // namespace duckdb
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/planner/table_filter.hpp"
+#include "notion_schema.hpp"
+#include <string>
+
+namespace duckdb {
+
+// A pushed-down filter together with the output column it applies to
+struct NotionColumnFilter {
+    idx_t output_idx;
+    const TableFilter *filter;
+};
+
+class NotionFilter {
+public:
+    // Translates a filter on column into conditions of a Notion query filter. The conditions
+    // select a superset of the matching pages; returns false if nothing could be translated.
+    static bool Translate(const TableFilter &filter, const NotionColumn &column, vector<std::string> &conditions);
+    // Condition selecting the pages edited at or after since (UTC)
+    static std::string EditedSince(timestamp_t since);
+    // Conditions selecting the pages created at or after / before a point in time (UTC)
+    static std::string CreatedOnOrAfter(timestamp_t start);
+    static std::string CreatedBefore(timestamp_t end);
+    // Combines conditions into the "filter" object of a database query ("" when empty)
+    static std::string Combine(const vector<std::string> &conditions);
+
+    // Pushed-down filters are removed from the plan but Notion only pre-filters, so all of them,
+    // whatever their type, are re-evaluated locally. Returns their conjunction over output
+    // columns of the given types, or nullptr when there are none.
+    static unique_ptr<Expression> ToExpression(const vector<NotionColumnFilter> &filters,
+                                               const vector<LogicalType> &types);
+    // Evaluates a filter on a single value, e.g. of a column that is constant per database
+    static bool Matches(ClientContext &context, const TableFilter &filter, const Value &value);
+    // Keeps only the rows of a chunk that pass the filter expression, evaluated on whole vectors
+    static void Apply(ExpressionExecutor &executor, DataChunk &output);
+};
+
+} // namespace duckdb
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include <string>
+
+namespace duckdb {
+
+enum class NotionJsonType : uint8_t {
+    OBJECT,
+    ARRAY,
+    STRING,
+    NUMBER,
+    BOOLEAN,
+    NULL_VALUE,
+    INVALID
+};
+
+// A JSON string as it appears in the input: a view of the bytes between the quotes.
+// Escape sequences are only decoded when the string is materialized.
+struct NotionJsonString {
+    const char *data = nullptr;
+    idx_t size = 0;
+    bool has_escapes = false;
+
+    // Compares the decoded string against a plain (escape-free) literal
+    bool Equals(const char *literal) const;
+    bool Equals(const std::string &literal) const;
+    // Appends the decoded UTF-8 string to out
+    void AppendTo(std::string &out) const;
+    std::string ToString() const;
+};
+
+// Single-pass pull parser over a JSON document. The cursor never allocates and never
+// rescans input: every call consumes the next value (or member key) in document order.
+class NotionJsonCursor {
+public:
+    NotionJsonCursor(const char *data, idx_t size);
+    explicit NotionJsonCursor(const std::string &json);
+
+    // Type of the next value, without consuming it
+    NotionJsonType Peek();
+
+    // Consumes '{' and returns true if the next value is an object
+    bool EnterObject();
+    // Reads the next member key of the current object; returns false once '}' is consumed.
+    // Members must be separated by exactly one comma.
+    bool NextKey(NotionJsonString &key);
+    // Consumes '[' and returns true if the next value is an array
+    bool EnterArray();
+    // Returns true if another element follows in the current array; false once ']' is consumed
+    bool NextElement();
+
+    // Typed readers consume the next value. They return false (and skip the value)
+    // when it has a different type, e.g. null.
+    bool ReadString(NotionJsonString &result);
+    bool ReadNumber(double &result);
+    bool ReadBoolean(bool &result);
+    // Skips the next value, including nested objects and arrays
+    void SkipValue();
+    // Skips the next value and reports the byte range it occupied
+    void SkipValue(idx_t &start, idx_t &end);
+    // Scans the current object for a member key and leaves the cursor at its value
+    bool FindKey(const char *key);
+
+    bool HasError() const {
+        return error;
+    }
+    idx_t Position() const {
+        return pos;
+    }
+
+private:
+    void SkipWhitespace();
+    bool ScanString(NotionJsonString &result);
+    // Consumes the comma before the next member or element; returns false once close is consumed
+    bool NextMember(char close);
+    // Advances past the number at pos if it follows the JSON grammar; sets the error otherwise
+    bool ScanNumber();
+
+    const char *data;
+    idx_t size;
+    idx_t pos = 0;
+    bool error = false;
+    // True until the first member or element of the innermost open container was read
+    bool first_member = false;
+};
+
+} // namespace duckdb
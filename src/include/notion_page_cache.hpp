@@ -0,0 +1,70 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "notion_requests.hpp"
+#include <string>
+
+namespace duckdb {
+
+class FileSystem;
+
+// One cached cursor chain. Every write of a chain gets a new generation, so a chain that is
+// being replaced never mixes with the pages of the previous one.
+struct NotionCacheEntry {
+    std::string generation;
+    idx_t page_count = 0;
+};
+
+// Opt-in on-disk cache of query results, enabled by setting notion_cache_directory. A query is
+// stored as the raw response bodies of its cursor chain plus a manifest that is only written
+// once the chain is complete, so partially written chains are never served.
+class NotionPageCache {
+public:
+    static constexpr idx_t DEFAULT_TTL_SECONDS = 300;
+
+    NotionPageCache(FileSystem &fs, std::string directory, idx_t ttl_seconds);
+
+    // Returns nullptr unless notion_cache_directory is set
+    static shared_ptr<NotionPageCache> Create(ClientContext &context);
+    // Registers the notion_cache_clear() table function
+    static void RegisterFunctions(DatabaseInstance &db);
+
+    // Identifies a query by its database, the integration reading it and every option that
+    // changes its results
+    static std::string GetKey(const std::string &database_id, const std::string &auth_token,
+                              const NotionQueryOptions &options);
+
+    // Finds a complete entry that is younger than the TTL
+    bool Lookup(const std::string &key, NotionCacheEntry &entry);
+    std::string ReadPage(const std::string &key, const NotionCacheEntry &entry, idx_t page_index);
+
+    // Starts a new generation of key; pages are written one by one and published by Commit
+    NotionCacheEntry Begin();
+    void WritePage(const std::string &key, const NotionCacheEntry &entry, idx_t page_index, const std::string &body);
+    void Commit(const std::string &key, const NotionCacheEntry &entry);
+    // Removes the pages written for a chain that will not be committed
+    void Abandon(const std::string &key, const NotionCacheEntry &entry, idx_t pages_written);
+
+    // Row counts of complete scans, kept next to the cached queries so that cardinality estimates
+    // survive a restart. Unlike pages they have no TTL: they are only estimates.
+    bool ReadRowCount(const std::string &database_id, idx_t &row_count);
+    void WriteRowCount(const std::string &database_id, idx_t row_count);
+
+    // Removes all cached queries and row counts, and returns how many queries were removed
+    idx_t Clear();
+
+private:
+    bool ReadManifest(const std::string &key, NotionCacheEntry &entry, bool check_ttl);
+    void RemovePages(const std::string &key, const NotionCacheEntry &entry);
+    // Removes old pages of key that belong to no committed chain
+    void RemoveAbandonedPages(const std::string &key, const NotionCacheEntry &current);
+    std::string ManifestPath(const std::string &key);
+    std::string RowCountPath(const std::string &database_id);
+    std::string PagePath(const std::string &key, const NotionCacheEntry &entry, idx_t page_index);
+
+    FileSystem &fs;
+    std::string directory;
+    idx_t ttl_seconds;
+};
+
+} // namespace duckdb
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "notion_requests.hpp"
+#include "notion_page_cache.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace duckdb {
+
+// Location of one page object within a response body
+struct NotionResultSpan {
+    idx_t offset;
+    idx_t length;
+};
+
+// One page of database query results. The response body is kept as the only copy of the
+// data and released together with the page once all of its rows are emitted.
+struct NotionResultPage {
+    std::string body;
+    // The page objects of the "results" array, as views into body
+    vector<NotionResultSpan> results;
+    bool has_more = false;
+    std::string next_cursor;
+};
+
+// A query request that was started ahead of time, e.g. the first page requested at bind
+class NotionPendingQuery {
+public:
+    static shared_ptr<NotionPendingQuery> Start(const std::string &database_id, const std::string &auth_token,
+                                                const NotionQueryOptions &options);
+    // Hands the request over; called once, by the claiming scan
+    NotionRequestFuture Take();
+    // Returns true for the first caller only, so a bound query's page is consumed by a single scan
+    bool Claim() {
+        return !claimed.exchange(true);
+    }
+
+private:
+    std::atomic<bool> claimed {false};
+    // Cancels the request when the query is dropped unclaimed
+    NotionRequestFuture response;
+};
+
+// Walks the cursor chain of a database query. With a prefetch depth above zero, a background
+// thread requests page N+1 as soon as page N arrived, keeping at most prefetch_depth parsed
+// pages buffered while earlier pages are converted into DataChunks.
+class NotionPageStream {
+public:
+    static constexpr idx_t DEFAULT_PREFETCH_DEPTH = 2;
+
+    // With a cache, a fresh cached chain is replayed from disk instead of being requested, and a
+    // requested chain is written to the cache as it is read
+    NotionPageStream(std::string database_id, std::string auth_token, NotionQueryOptions options,
+                     idx_t prefetch_depth, shared_ptr<NotionPendingQuery> first_page = nullptr,
+                     shared_ptr<NotionPageCache> cache = nullptr);
+    ~NotionPageStream();
+
+    // Returns the next page of results, or false once the cursor chain is exhausted
+    bool Next(NotionResultPage &page);
+
+    // Parses a query response in one pass, taking ownership of the body
+    static NotionResultPage ParseResponse(std::string body);
+
+private:
+    // Returns false when the stream was destroyed while the request was in flight
+    bool Fetch(const std::string &start_cursor, NotionResultPage &page);
+    bool Stopped();
+    void StorePage(const std::string &body, bool last_page);
+    void Prefetch();
+
+    std::string database_id;
+    std::string auth_token;
+    NotionQueryOptions options;
+    idx_t prefetch_depth;
+    shared_ptr<NotionPendingQuery> first_page;
+
+    shared_ptr<NotionPageCache> cache;
+    std::string cache_key;
+    NotionCacheEntry cache_entry;
+    // True when the chain is replayed from the cache
+    bool cached = false;
+    // True once the requested chain was written to the cache completely
+    bool committed = false;
+    idx_t page_index = 0;
+
+    // Cursor state of the chain (owned by the worker thread when prefetching)
+    bool has_more = true;
+    std::string next_cursor;
+
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable page_cv;
+    std::deque<NotionResultPage> pages;
+    bool finished = false;
+    bool stopped = false;
+    std::exception_ptr error;
+};
+
+} // namespace duckdb
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include <chrono>
+#include <mutex>
+#include <string>
+
+namespace duckdb {
+
+// Token bucket shared by concurrent requests. Allows requests_per_second on average with
+// bursts of up to burst requests; callers that exceed the rate wait for their turn.
+class NotionRateLimiter {
+public:
+    // Notion allows an average of three requests per second per integration
+    static constexpr double DEFAULT_REQUESTS_PER_SECOND = 3.0;
+
+    explicit NotionRateLimiter(double requests_per_second, double burst = 1.0);
+
+    // Returns the limiter shared by every request made with auth_token. Notion enforces its
+    // limit per integration, so all queries and copies using the same token draw from one bucket.
+    static NotionRateLimiter &ForToken(const std::string &auth_token);
+    // Settings callback for notion_requests_per_second; applies to all limiters
+    static void SetDefaultRate(ClientContext &context, SetScope scope, Value &parameter);
+
+    // Blocks until the caller may send a request
+    void Acquire();
+    // Takes a token without waiting and returns when the request may be sent
+    std::chrono::steady_clock::time_point Reserve();
+    // Gives back the token of a reservation whose request was not sent
+    void Release();
+    // Holds back all callers for the given time, e.g. after the server answered with Retry-After
+    void Pause(double seconds);
+    void SetRate(double requests_per_second);
+
+private:
+    void Refill(std::chrono::steady_clock::time_point now);
+
+    std::mutex lock;
+    double requests_per_second;
+    double burst;
+    // May go negative: each waiting caller reserves a token ahead of time
+    double tokens;
+    std::chrono::steady_clock::time_point last_refill;
+    // No request is sent before this point in time
+    std::chrono::steady_clock::time_point paused_until;
+};
+
+} // namespace duckdb
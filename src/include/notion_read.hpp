@@ -1,12 +1,23 @@
 #pragma once
 
 #include "duckdb.hpp"
+#include "notion_schema.hpp"
+#include <string>
 
 namespace duckdb {
 
 class NotionRead {
 public:
+    // Scans are not split into partitions unless notion_scan_partitions is raised
+    static constexpr idx_t DEFAULT_SCAN_PARTITIONS = 1;
+
     static void RegisterTableFunction(DatabaseInstance &db);
+
+    // The read_notion scan of a single database, and its bind data for a database whose columns
+    // are already known (e.g. a table of an attached workspace)
+    static TableFunction GetFunction();
+    static unique_ptr<FunctionData> BindTable(ClientContext &context, const std::string &database_id,
+                                              const vector<NotionColumn> &columns);
 };
 
 } // namespace duckdb
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "notion_requests.hpp"
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace duckdb {
+
+// Resolves the page ids of relation columns to the titles of the related pages
+// (read_notion(..., expand_relations = true)). Titles are kept for the whole scan, so every
+// related page is requested once no matter how many rows reference it.
+class NotionRelationResolver {
+public:
+    // Related pages requested concurrently while a chunk is expanded
+    static constexpr idx_t DEFAULT_CONCURRENCY = 8;
+
+    NotionRelationResolver(std::string auth_token, idx_t concurrency);
+
+    // LIST(STRUCT(id VARCHAR, title VARCHAR)), the type of an expanded relation column
+    static LogicalType GetLogicalType();
+
+    // Writes count rows of each LIST(VARCHAR) id vector to its expanded vector. The ids of all
+    // columns are collected first, and the pages not seen before are requested concurrently.
+    void Expand(const vector<reference<Vector>> &ids, const vector<reference<Vector>> &results, idx_t count);
+
+private:
+    // Waits for the titles of the given pages, requesting the ones no other lookup started
+    void Resolve(const vector<std::string> &page_ids, std::unordered_map<std::string, Value> &titles);
+    // The title of a requested page, NULL when the integration cannot read it
+    Value ReadTitle(NotionResponse response);
+
+    std::string auth_token;
+    idx_t concurrency;
+    std::mutex lock;
+    // Title by page id (NULL for pages the integration cannot read), shared by all scan threads
+    std::unordered_map<std::string, std::shared_future<Value>> pages;
+};
+
+} // namespace duckdb
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "duckdb.hpp"
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <string>
 
 namespace duckdb {
@@ -9,35 +12,150 @@ struct NotionResponse {
     std::string body;
     int status_code;
     bool success;
+    // Seconds from the Retry-After header of a rate limited response, 0 when absent
+    double retry_after = 0;
+};
+
+// Optional parameters of a database query
+struct NotionQueryOptions {
+    // JSON "filter" object, evaluated by Notion before pages are returned
+    std::string filter;
+    // Ids of the properties to return; all properties are returned when empty
+    vector<std::string> filter_properties;
+    // JSON "sorts" array; Notion's default order when empty
+    std::string sorts;
+    // Results per page; Notion's default (100) when 0
+    idx_t page_size = 0;
+};
+
+// The response of a request sent with one of the *Async functions. Dropping the future before
+// its response was taken cancels the request: an attempt that was not sent yet is dropped and
+// gives back its rate limit token, and a failed attempt is not retried.
+class NotionRequestFuture {
+public:
+    NotionRequestFuture() = default;
+    NotionRequestFuture(std::future<NotionResponse> response, shared_ptr<std::atomic<bool>> cancelled);
+    NotionRequestFuture(NotionRequestFuture &&other) noexcept = default;
+    NotionRequestFuture &operator=(NotionRequestFuture &&other) noexcept;
+    ~NotionRequestFuture();
+
+    bool Valid() const {
+        return response.valid();
+    }
+    // True once the response arrived, waiting up to timeout for it
+    template <class REP, class PERIOD>
+    bool WaitFor(const std::chrono::duration<REP, PERIOD> &timeout) const {
+        return response.wait_for(timeout) == std::future_status::ready;
+    }
+    // Blocks until the response arrived and hands it over
+    NotionResponse Get();
+    void Cancel();
+
+private:
+    std::future<NotionResponse> response;
+    shared_ptr<std::atomic<bool>> cancelled;
 };
 
 class NotionRequests {
 public:
+    // Body of the response of a cancelled request
+    static constexpr const char *CANCELLED_MESSAGE = "Notion API request cancelled";
+
+    static constexpr idx_t DEFAULT_MAX_RETRIES = 5;
+    static constexpr const char *DEFAULT_API_BASE_URL = "https://api.notion.com/v1";
+
+    // Settings callback for notion_max_retries
+    static void SetMaxRetries(ClientContext &context, SetScope scope, Value &parameter);
+    // Settings callback for notion_api_base_url. Plain http:// URLs are accepted so that the
+    // extension can be pointed at a local stand-in server.
+    static void SetBaseUrl(ClientContext &context, SetScope scope, Value &parameter);
+    static std::string GetBaseUrl();
+
     static NotionResponse QueryDatabase(const std::string &database_id,
                                         const std::string &auth_token,
                                         const std::string &start_cursor = "",
-                                        const std::string &data_source_id = "");
+                                        const std::string &data_source_id = "",
+                                        const NotionQueryOptions &options = NotionQueryOptions());
+
+    // The *Async variants return immediately; with the event loop transport (notion_io_threads > 0)
+    // many of them can be in flight without a thread each
+    static NotionRequestFuture QueryDatabaseAsync(const std::string &database_id,
+                                                  const std::string &auth_token,
+                                                  const std::string &start_cursor = "",
+                                                  const std::string &data_source_id = "",
+                                                  const NotionQueryOptions &options = NotionQueryOptions());
 
     static NotionResponse GetDatabase(const std::string &database_id,
                                       const std::string &auth_token);
+    static NotionRequestFuture GetDatabaseAsync(const std::string &database_id,
+                                                const std::string &auth_token);
 
     static NotionResponse GetDataSource(const std::string &database_id,
                                        const std::string &auth_token);
 
+    // A single page; only the given properties are returned when properties is not empty
+    static NotionResponse GetPage(const std::string &page_id,
+                                  const std::string &auth_token,
+                                  const vector<std::string> &properties = vector<std::string>());
+    static NotionRequestFuture GetPageAsync(const std::string &page_id,
+                                            const std::string &auth_token,
+                                            const vector<std::string> &properties = vector<std::string>());
+
+    // One page of the objects of the given type ("page" or "data_source") shared with the integration
+    static NotionResponse Search(const std::string &auth_token,
+                                 const std::string &object_type,
+                                 const std::string &start_cursor = "");
+
+    // One page of the children of a block (pages are blocks too)
+    static NotionResponse GetBlockChildren(const std::string &block_id,
+                                           const std::string &auth_token,
+                                           const std::string &start_cursor = "");
+
     static NotionResponse CreatePage(const std::string &database_id,
                                      const std::string &auth_token,
                                      const std::string &properties,
                                      const std::string &data_source_id = "");
+    static NotionRequestFuture CreatePageAsync(const std::string &database_id,
+                                               const std::string &auth_token,
+                                               const std::string &properties,
+                                               const std::string &data_source_id = "");
 
     static NotionResponse UpdatePage(const std::string &page_id,
                                      const std::string &auth_token,
                                      const std::string &properties);
+    static NotionRequestFuture UpdatePageAsync(const std::string &page_id,
+                                               const std::string &auth_token,
+                                               const std::string &properties);
 
 private:
+    // Sends a request through the rate limiter of auth_token, retrying rate limited and transient
+    // failures. Requests that are not idempotent are only retried when the server cannot have
+    // processed them.
     static NotionResponse MakeRequest(const std::string &url,
                                       const std::string &auth_token,
                                       const std::string &method = "GET",
-                                      const std::string &body = "");
+                                      const std::string &body = "",
+                                      bool idempotent = true);
+    // MakeRequest through the event loop transport, or on a thread of its own when it is disabled
+    static NotionRequestFuture MakeRequestAsync(const std::string &url,
+                                                const std::string &auth_token,
+                                                const std::string &method = "GET",
+                                                const std::string &body = "",
+                                                bool idempotent = true);
+    // MakeRequest on the calling thread with blocking I/O. Once cancelled is set, the request
+    // stops waiting for its turn or its retry and is not sent again.
+    static NotionResponse MakeBlockingRequest(const std::string &url,
+                                              const std::string &auth_token,
+                                              const std::string &method,
+                                              const std::string &body,
+                                              bool idempotent,
+                                              const std::atomic<bool> *cancelled = nullptr);
+    // Sends a request once. Sets delivered when the request was written to the connection.
+    static NotionResponse SendRequest(const std::string &url,
+                                      const std::string &auth_token,
+                                      const std::string &method,
+                                      const std::string &body,
+                                      bool &delivered);
 };
 
 } // namespace duckdb
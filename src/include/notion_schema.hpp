@@ -0,0 +1,71 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include <string>
+
+namespace duckdb {
+
+enum class NotionPropertyType : uint8_t {
+    PAGE_ID,
+    TITLE,
+    RICH_TEXT,
+    NUMBER,
+    CHECKBOX,
+    SELECT,
+    STATUS,
+    MULTI_SELECT,
+    DATE,
+    URL,
+    EMAIL,
+    PHONE_NUMBER,
+    CREATED_TIME,
+    LAST_EDITED_TIME,
+    CREATED_BY,
+    LAST_EDITED_BY,
+    PEOPLE,
+    RELATION,
+    UNIQUE_ID,
+    FORMULA,
+    OTHER
+};
+
+// A property as described by the database schema
+struct NotionProperty {
+    std::string name;
+    std::string id;
+    NotionPropertyType type;
+    // Option names of select, status and multi-select properties, in schema order
+    vector<std::string> options;
+};
+
+// An output column of read_notion: either a database property or a page-level field
+// (id, created_time, last_edited_time)
+struct NotionColumn {
+    std::string name;
+    // Property name, or the member name of the page object for page-level fields
+    std::string key;
+    // Property id, used to select properties in queries (empty for page-level fields)
+    std::string property_id;
+    bool is_property;
+    NotionPropertyType type;
+    LogicalType logical_type;
+};
+
+class NotionSchema {
+public:
+    // Parses the "properties" object of a database response, in schema order
+    static vector<NotionProperty> ParseProperties(const std::string &json);
+    static NotionPropertyType GetPropertyType(const std::string &type_name);
+    static LogicalType GetLogicalType(NotionPropertyType type);
+    // As above, but select and status properties with options are read as an ENUM of them and
+    // multi-select properties as a LIST of that ENUM
+    static LogicalType GetLogicalType(const NotionProperty &property);
+    static LogicalType GetEnumType(const vector<std::string> &options);
+    // Reads select, status and multi-select columns as text instead, e.g. where values may not be
+    // options of the schema the columns were built from
+    static void UseTextTypes(vector<NotionColumn> &columns);
+    // Builds the read_notion columns: the page id, every property, then the page timestamps
+    static vector<NotionColumn> GetColumns(const vector<NotionProperty> &properties);
+};
+
+} // namespace duckdb
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/storage/object_cache.hpp"
+#include "notion_requests.hpp"
+#include <chrono>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace duckdb {
+
+// Caches database metadata responses for all connections of a DatabaseInstance, so that
+// repeated binds of the same database skip the GetDatabase round trip. Concurrent lookups of
+// the same database share a single request.
+class NotionSchemaCache : public ObjectCacheEntry {
+public:
+    static constexpr idx_t DEFAULT_TTL_SECONDS = 60;
+
+    static NotionSchemaCache &Get(ClientContext &context);
+    // The notion_schema_cache_ttl setting
+    static std::chrono::seconds GetTTL(ClientContext &context);
+    // Registers the notion_schema_cache_clear() table function
+    static void RegisterFunctions(DatabaseInstance &db);
+
+    // Cached NotionRequests::GetDatabase and GetDataSource, honoring notion_schema_cache_ttl
+    NotionResponse GetDatabase(ClientContext &context, const std::string &database_id, const std::string &auth_token);
+    NotionResponse GetDataSource(ClientContext &context, const std::string &database_id,
+                                 const std::string &auth_token);
+    // GetDatabase for several databases at once, with the uncached ones requested concurrently
+    vector<NotionResponse> GetDatabases(ClientContext &context, const vector<std::string> &database_ids,
+                                        const std::string &auth_token);
+
+    // Drops the entries of database_id, or all entries when it is empty; returns how many were dropped
+    idx_t Invalidate(const std::string &database_id);
+
+    static std::string ObjectType() {
+        return "notion_schema_cache";
+    }
+    std::string GetObjectType() override {
+        return ObjectType();
+    }
+
+private:
+    struct Entry {
+        std::string database_id;
+        // Identifies the lookup that created the entry
+        idx_t lookup_id;
+        std::shared_future<NotionResponse> response;
+        std::chrono::steady_clock::time_point fetched_at;
+    };
+
+    NotionResponse Lookup(std::chrono::seconds ttl, const std::string &key, const std::string &database_id,
+                          const std::function<NotionResponse()> &fetch);
+    // Joins the fresh or in-flight entry of key, returning 0 with response set to it, or makes the
+    // caller the owner of a new lookup and returns its id
+    idx_t BeginLookup(std::chrono::seconds ttl, const std::string &key, const std::string &database_id,
+                      std::promise<NotionResponse> &promise, std::shared_future<NotionResponse> &response);
+    // Runs fetch for an owned lookup and hands its result, or its exception, to the waiting callers
+    NotionResponse FinishLookup(const std::string &key, idx_t lookup_id, std::promise<NotionResponse> &promise,
+                                const std::function<NotionResponse()> &fetch);
+
+    std::mutex lock;
+    std::unordered_map<std::string, Entry> entries;
+    idx_t last_lookup_id = 0;
+};
+
+} // namespace duckdb
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "notion_schema.hpp"
+#include <string>
+
+namespace duckdb {
+
+// How one copied column is written: everything up to its value is precomputed at bind
+struct NotionPropertyWriter {
+    idx_t column_idx;
+    NotionPropertyType type;
+    // e.g. "Name":{"title":
+    std::string prefix;
+    // Type the column is cast to before it is serialized
+    LogicalType value_type;
+};
+
+// Serializes the rows of a DataChunk into the "properties" objects of page requests,
+// reading each column through its unified format rather than per-cell Values.
+class NotionPropertySerializer {
+public:
+    // Notion rejects text objects with more content than this
+    static constexpr idx_t MAX_TEXT_LENGTH = 2000;
+
+    // Builds the writers of the copied columns, given the database column each one maps to. Page
+    // fields and computed properties (formulas, timestamps, ...) cannot be written and are skipped.
+    static vector<NotionPropertyWriter> Bind(const vector<LogicalType> &column_types,
+                                             const vector<NotionColumn> &target_columns,
+                                             const vector<idx_t> &target_column_ids);
+
+    NotionPropertySerializer(ClientContext &context, const vector<NotionPropertyWriter> &writers);
+
+    // Casts the columns of the next chunk where needed
+    void SetChunk(DataChunk &input);
+    // Appends the properties object of a row of the current chunk to result
+    void Serialize(idx_t row, std::string &result);
+    // Appends the JSON value one writer sends for a row; returns false when the property is left
+    // out of the request (a NULL status)
+    bool SerializeValue(idx_t writer_idx, idx_t row, std::string &result);
+
+private:
+    void WriteText(const string_t &text, std::string &result);
+    void WriteValue(idx_t writer_idx, idx_t row, std::string &result);
+
+    ClientContext &context;
+    const vector<NotionPropertyWriter> &writers;
+    // Per writer: the vector holding cast values (when the column had another type) and its formats
+    vector<unique_ptr<Vector>> cast_vectors;
+    vector<UnifiedVectorFormat> formats;
+    vector<UnifiedVectorFormat> child_formats;
+};
+
+} // namespace duckdb
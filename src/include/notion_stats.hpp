@@ -0,0 +1,95 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace duckdb {
+
+// Stages of a request or scan whose latency is tracked
+enum class NotionStatPhase : uint8_t {
+    // Opening a new connection, including the TLS handshake
+    CONNECT,
+    // Waiting for the rate limiter
+    RATE_LIMIT_WAIT,
+    // Sleeping before a retry
+    RETRY_BACKOFF,
+    // From sending a request until its response headers arrived
+    TIME_TO_FIRST_BYTE,
+    // Receiving the response body
+    TRANSFER,
+    DECOMPRESS,
+    // Splitting a query response into its page objects
+    PARSE,
+    // Writing page objects into DataChunks
+    DECODE,
+    // Turning COPY rows into page properties
+    SERIALIZE,
+    COUNT
+};
+
+// Latency histogram with power-of-two microsecond buckets; safe to update concurrently
+class NotionLatencyHistogram {
+public:
+    static constexpr idx_t BUCKET_COUNT = 40;
+
+    void Record(uint64_t micros, idx_t count = 1);
+    void Reset();
+
+    uint64_t Count() const {
+        return count;
+    }
+    uint64_t TotalMicros() const {
+        return total_micros;
+    }
+    uint64_t MaxMicros() const {
+        return max_micros;
+    }
+    // Upper bound of the bucket holding the given quantile (0..1)
+    uint64_t Percentile(double quantile) const;
+
+private:
+    std::atomic<uint64_t> buckets[BUCKET_COUNT] {};
+    std::atomic<uint64_t> count {0};
+    std::atomic<uint64_t> total_micros {0};
+    std::atomic<uint64_t> max_micros {0};
+};
+
+// Process-wide request and scan metrics, exposed through notion_stats()
+class NotionStats {
+public:
+    static NotionStats &Get();
+    // Registers notion_stats() and notion_stats_reset()
+    static void RegisterFunctions(DatabaseInstance &db);
+
+    void Record(NotionStatPhase phase, uint64_t micros, idx_t count = 1);
+    // Records a finished API call, including all of its retries
+    void RecordRequest(const std::string &method, const std::string &url, int status_code, idx_t retries,
+                       uint64_t micros, idx_t bytes);
+    void Reset();
+
+    static uint64_t ElapsedMicros(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+            .count();
+    }
+
+private:
+    friend struct NotionStatsFunctions;
+
+    struct RequestStats {
+        NotionLatencyHistogram latency;
+        uint64_t bytes = 0;
+    };
+    // Endpoint (e.g. "POST /v1/databases/{id}/query"), status code and retry count
+    using RequestKey = std::tuple<std::string, int, idx_t>;
+
+    NotionLatencyHistogram phases[static_cast<idx_t>(NotionStatPhase::COUNT)];
+    std::mutex lock;
+    std::map<RequestKey, unique_ptr<RequestStats>> requests;
+};
+
+} // namespace duckdb
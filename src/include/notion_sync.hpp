@@ -0,0 +1,13 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+class NotionSync {
+public:
+    // Registers notion_sync(database, target_table)
+    static void RegisterTableFunction(DatabaseInstance &db);
+};
+
+} // namespace duckdb
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "notion_requests.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace duckdb {
+
+class NotionEventLoop;
+struct NotionInflater;
+
+// Incremental parser of one HTTP/1.1 response framed by Content-Length, chunked encoding or the
+// end of the connection. Bytes are read straight into its buffer, which ends up as the body:
+// chunk data is moved down over the framing already parsed. A gzip body is inflated as it
+// arrives instead, so the compressed bytes are dropped as soon as they were decoded.
+class NotionHttpParser {
+public:
+    // Upper bound of a single read from a connection; TLS records hold at most 16KB anyway
+    static constexpr idx_t READ_SIZE = 16384;
+
+    NotionHttpParser();
+    ~NotionHttpParser();
+    NotionHttpParser(NotionHttpParser &&other) noexcept;
+    NotionHttpParser &operator=(NotionHttpParser &&other) noexcept;
+
+    // Returns room for up to size bytes at the end of the buffer, to be filled and then committed
+    char *Reserve(idx_t size);
+    // Adds the first size bytes of the reserved room; returns true once the response is complete
+    bool Commit(idx_t size);
+    // The connection was closed: completes a response delimited by the end of the connection.
+    // Returns false when the response was cut short.
+    bool Close();
+
+    bool HeadersRead() const {
+        return state != State::HEADERS;
+    }
+    bool Failed() const {
+        return state == State::FAILED;
+    }
+    // True when the server allows another request on the connection
+    bool KeepAlive() const {
+        return keep_alive;
+    }
+    // Hands over the complete response, decompressing a gzip body
+    NotionResponse TakeResponse();
+
+private:
+    enum class State : uint8_t { HEADERS, BODY_LENGTH, BODY_CLOSE, CHUNK_SIZE, CHUNK_DATA, CHUNK_TRAILER, DONE, FAILED };
+
+    void ParseHeaders(const std::string &headers);
+    bool Advance();
+    // Inflates the first count bytes of the buffer and removes them; false on a corrupt stream
+    bool Inflate(idx_t count);
+
+    State state = State::HEADERS;
+    std::string buffer;
+    // Bytes of buffer that were read; the rest is reserved room
+    idx_t size = 0;
+    // Bytes already searched for the end of the headers
+    idx_t searched = 0;
+    NotionResponse response;
+    bool keep_alive = false;
+    bool gzip = false;
+    idx_t content_length = 0;
+    // Chunked bodies: position of the next unparsed framing, decoded bytes and the current chunk size
+    idx_t pos = 0;
+    idx_t body_size = 0;
+    idx_t chunk_size = 0;
+    // Gzip bodies: the decoder, the inflated body with its used size, and the compressed bytes
+    // inflated so far
+    unique_ptr<NotionInflater> inflater;
+    std::string inflated;
+    idx_t inflated_size = 0;
+    idx_t inflated_in = 0;
+    uint64_t inflate_micros = 0;
+};
+
+// Sends HTTP requests over non-blocking sockets multiplexed on a few I/O threads, each running
+// an epoll event loop. Connections come from and return to the shared NotionConnectionPool, so
+// dozens of requests can be in flight without a thread per request. Only Linux has the event
+// loop; elsewhere, or with notion_io_threads = 0, requests are sent with blocking I/O instead.
+class NotionTransport {
+public:
+    static constexpr idx_t DEFAULT_IO_THREADS = 2;
+
+    // Receives the response of a request, and whether any of it was written to the server
+    using Callback = std::function<void(NotionResponse response, bool delivered)>;
+
+    static NotionTransport &Get();
+    // Settings callback for notion_io_threads
+    static void SetIoThreads(ClientContext &context, SetScope scope, Value &parameter);
+
+    // True when requests are sent by the event loop
+    bool Enabled() const;
+    // Sends a serialized request to host at send_at (or as soon as possible after it). done is
+    // called on an I/O thread and must not block. Once cancelled is set, a request that was not
+    // started yet is dropped and done receives a failed, undelivered response.
+    void Send(const std::string &host, bool secure, std::string request,
+              std::chrono::steady_clock::time_point send_at, shared_ptr<std::atomic<bool>> cancelled, Callback done);
+    // Wakes the event loops to drop the cancelled requests waiting for their send time
+    void Sweep();
+
+private:
+    NotionTransport();
+
+    std::atomic<idx_t> io_threads {DEFAULT_IO_THREADS};
+    std::atomic<idx_t> next_loop {0};
+    std::mutex lock;
+    // The event loops, started on first use; never stopped, like the connection pool
+    vector<NotionEventLoop *> loops;
+};
+
+} // namespace duckdb
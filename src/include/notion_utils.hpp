@@ -10,6 +10,13 @@ public:
     static std::string ExtractDatabaseId(const std::string &input);
     static bool IsNotionUrl(const std::string &input);
     static std::string ParseJsonString(const std::string &json, const std::string &key);
+    // Appends value to out as a quoted, escaped JSON string
+    static void AppendJsonString(std::string &out, const char *value, idx_t length);
+    static void AppendJsonString(std::string &out, const std::string &value);
+    // Formats a UTC timestamp in ISO 8601, e.g. "2024-05-01T12:30:00Z"
+    static std::string ToIsoTimestamp(timestamp_t value);
+    // Settings shared by every database of the process can only be changed with SET GLOBAL
+    static void CheckGlobalScope(SetScope scope, const std::string &setting);
 };
 
 } // namespace duckdb
@@ -4,6 +4,9 @@
 
 namespace duckdb {
 
+// Default number of CreatePage requests each COPY thread keeps in flight
+static constexpr idx_t NOTION_DEFAULT_COPY_CONCURRENCY = 4;
+
 class NotionWrite {
 public:
     static void RegisterCopyFunction(DatabaseInstance &db);
@@ -0,0 +1,351 @@
+#include "notion_blocks.hpp"
+#include "notion_auth.hpp"
+#include "notion_decoder.hpp"
+#include "notion_json.hpp"
+#include "notion_page_stream.hpp"
+#include "notion_requests.hpp"
+#include "notion_schema.hpp"
+#include "notion_schema_cache.hpp"
+#include "notion_utils.hpp"
+#include "duckdb/main/extension_util.hpp"
+#include "duckdb/common/exception.hpp"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace duckdb {
+
+// Rows the crawl buffers ahead of the scan before its workers wait
+static constexpr idx_t MAX_BUFFERED_ROWS = 4 * STANDARD_VECTOR_SIZE;
+
+struct NotionBlocksBindData : public TableFunctionData {
+    std::string root_id;
+    std::string auth_token;
+    // The root is a database whose pages are crawled, rather than a page
+    bool is_database = false;
+    // Query options listing the pages of the database
+    NotionQueryOptions database_options;
+    idx_t concurrency;
+};
+
+// A block whose children are still to be read. The root of a database crawl is a task too.
+struct NotionBlockTask {
+    std::string block_id;
+    // The page the block belongs to: the nearest enclosing page, including child pages
+    std::string page_id;
+    int32_t depth;
+    bool list_database;
+};
+
+struct NotionBlockRow {
+    std::string page_id;
+    std::string block_id;
+    std::string parent_id;
+    int32_t depth;
+    int32_t position;
+    std::string type;
+    bool has_text = false;
+    std::string plain_text;
+    bool has_children = false;
+};
+
+// Crawls block children breadth-first with a pool of worker threads. Each worker reads the
+// complete child list of one block at a time; blocks with children are queued behind the
+// blocks already waiting, and their rows are buffered for the scan.
+struct NotionBlocksGlobalState : public GlobalTableFunctionState {
+    ~NotionBlocksGlobalState() override {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopped = true;
+        }
+        work_cv.notify_all();
+        rows_cv.notify_all();
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    }
+
+    // True once every queued block was read
+    bool Done() const {
+        return tasks.empty() && active == 0;
+    }
+
+    std::string auth_token;
+    NotionQueryOptions database_options;
+
+    std::mutex lock;
+    // Signals queued tasks to the workers
+    std::condition_variable work_cv;
+    // Signals buffered rows to the scan and free buffer space to the workers
+    std::condition_variable rows_cv;
+    std::deque<NotionBlockTask> tasks;
+    // Tasks being read by a worker
+    idx_t active = 0;
+    std::deque<NotionBlockRow> rows;
+    bool stopped = false;
+    std::exception_ptr error;
+    vector<std::thread> workers;
+};
+
+static unique_ptr<FunctionData> NotionBlocksBind(ClientContext &context, TableFunctionBindInput &input,
+                                                 vector<LogicalType> &return_types, vector<string> &names) {
+    auto bind_data = make_uniq<NotionBlocksBindData>();
+    bind_data->root_id = NotionUtils::ExtractDatabaseId(input.inputs[0].ToString());
+    bind_data->auth_token = NotionAuth::GetAuthToken(context);
+
+    Value concurrency;
+    bind_data->concurrency = NotionBlocks::DEFAULT_CONCURRENCY;
+    if (context.TryGetCurrentSetting("notion_block_concurrency", concurrency) && !concurrency.IsNull()) {
+        bind_data->concurrency = MaxValue<idx_t>(concurrency.GetValue<uint64_t>(), 1);
+    }
+
+    // Pages and databases share the id format; only a database has a schema
+    auto db_response = NotionSchemaCache::Get(context).GetDatabase(context, bind_data->root_id, bind_data->auth_token);
+    if (db_response.success) {
+        bind_data->is_database = true;
+        // Only the page ids are needed, so a single property is requested
+        for (const auto &property : NotionSchema::ParseProperties(db_response.body)) {
+            bind_data->database_options.filter_properties.push_back(property.id);
+            break;
+        }
+    } else if (db_response.status_code != 404 &&
+               NotionUtils::ParseJsonString(db_response.body, "code") != "validation_error") {
+        // Notion answers for a page with one of these; any other failure is not a page
+        throw IOException("Failed to read Notion page or database " + bind_data->root_id + ": " + db_response.body);
+    }
+
+    names = {"page_id", "block_id", "parent_id", "depth", "position", "type", "plain_text", "has_children"};
+    return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR,  LogicalType::INTEGER,
+                    LogicalType::INTEGER, LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::BOOLEAN};
+    return std::move(bind_data);
+}
+
+// Reads the type-specific member of a block, e.g. "paragraph":{"rich_text":[...]}, for its text
+static void ReadBlockContent(NotionJsonCursor &cursor, NotionBlockRow &row) {
+    if (!cursor.EnterObject()) {
+        return;
+    }
+    NotionJsonString key;
+    while (cursor.NextKey(key)) {
+        if (key.Equals("rich_text")) {
+            row.has_text = NotionPageDecoder::ReadRichText(cursor, row.plain_text) || row.has_text;
+        } else if (key.Equals("title")) {
+            // Child pages and databases
+            NotionJsonString title;
+            if (cursor.ReadString(title)) {
+                title.AppendTo(row.plain_text);
+                row.has_text = true;
+            }
+        } else {
+            cursor.SkipValue();
+        }
+    }
+}
+
+static void ParseBlock(const char *data, idx_t size, NotionBlockRow &row) {
+    NotionJsonCursor cursor(data, size);
+    if (!cursor.EnterObject()) {
+        return;
+    }
+    NotionJsonString key;
+    while (cursor.NextKey(key)) {
+        if (key.Equals("id")) {
+            NotionJsonString id;
+            if (cursor.ReadString(id)) {
+                row.block_id = id.ToString();
+            }
+        } else if (key.Equals("type")) {
+            NotionJsonString type;
+            if (cursor.ReadString(type)) {
+                row.type = type.ToString();
+            }
+        } else if (key.Equals("has_children")) {
+            cursor.ReadBoolean(row.has_children);
+        } else if (key.Equals("parent") || key.Equals("created_by") || key.Equals("last_edited_by")) {
+            cursor.SkipValue();
+        } else {
+            // The only other object member is the content named by the block type
+            ReadBlockContent(cursor, row);
+        }
+    }
+}
+
+// Hands the rows and child tasks of one response to the scan and the workers. Waits while the row
+// buffer is full; returns false when the crawl was stopped.
+static bool PushResults(NotionBlocksGlobalState &state, vector<NotionBlockRow> &rows,
+                        vector<NotionBlockTask> &children) {
+    std::unique_lock<std::mutex> guard(state.lock);
+    state.rows_cv.wait(guard, [&]() { return state.stopped || state.rows.size() < MAX_BUFFERED_ROWS; });
+    if (state.stopped) {
+        return false;
+    }
+    for (auto &row : rows) {
+        state.rows.push_back(std::move(row));
+    }
+    for (auto &child : children) {
+        state.tasks.push_back(std::move(child));
+    }
+    state.rows_cv.notify_all();
+    if (!children.empty()) {
+        state.work_cv.notify_all();
+    }
+    return true;
+}
+
+// Queues every page of the database as the root of a page crawl
+static void ListDatabasePages(NotionBlocksGlobalState &state, const NotionBlockTask &task) {
+    NotionPageStream stream(task.block_id, state.auth_token, state.database_options, 0);
+    NotionResultPage page;
+    while (stream.Next(page)) {
+        vector<NotionBlockRow> rows;
+        vector<NotionBlockTask> pages;
+        for (const auto &result : page.results) {
+            NotionJsonCursor cursor(page.body.data() + result.offset, result.length);
+            NotionJsonString id;
+            if (cursor.EnterObject() && cursor.FindKey("id") && cursor.ReadString(id)) {
+                auto page_id = id.ToString();
+                pages.push_back({page_id, page_id, 0, false});
+            }
+        }
+        if (!PushResults(state, rows, pages)) {
+            return;
+        }
+    }
+}
+
+// Reads the complete child list of a block, one response page at a time
+static void ReadChildren(NotionBlocksGlobalState &state, const NotionBlockTask &task) {
+    std::string cursor;
+    int32_t position = 0;
+    do {
+        auto response = NotionRequests::GetBlockChildren(task.block_id, state.auth_token, cursor);
+        if (!response.success) {
+            throw InvalidInputException("Failed to read Notion blocks: " + response.body);
+        }
+        auto page = NotionPageStream::ParseResponse(std::move(response.body));
+
+        vector<NotionBlockRow> rows;
+        vector<NotionBlockTask> children;
+        for (const auto &result : page.results) {
+            NotionBlockRow row;
+            row.page_id = task.page_id;
+            row.parent_id = task.block_id;
+            row.depth = task.depth;
+            row.position = position++;
+            ParseBlock(page.body.data() + result.offset, result.length, row);
+            if (row.has_children && !row.block_id.empty()) {
+                // A child page starts a page of its own
+                if (row.type == "child_page") {
+                    children.push_back({row.block_id, row.block_id, 0, false});
+                } else {
+                    children.push_back({row.block_id, task.page_id, task.depth + 1, false});
+                }
+            }
+            rows.push_back(std::move(row));
+        }
+        if (!PushResults(state, rows, children)) {
+            return;
+        }
+        cursor = page.has_more ? page.next_cursor : "";
+    } while (!cursor.empty());
+}
+
+static void RunWorker(NotionBlocksGlobalState &state) {
+    while (true) {
+        NotionBlockTask task;
+        {
+            std::unique_lock<std::mutex> guard(state.lock);
+            state.work_cv.wait(guard, [&]() { return state.stopped || !state.tasks.empty() || state.Done(); });
+            if (state.stopped || state.tasks.empty()) {
+                return;
+            }
+            task = std::move(state.tasks.front());
+            state.tasks.pop_front();
+            state.active++;
+        }
+
+        try {
+            if (task.list_database) {
+                ListDatabasePages(state, task);
+            } else {
+                ReadChildren(state, task);
+            }
+        } catch (...) {
+            // The first failure ends the crawl and is raised by the scan
+            std::lock_guard<std::mutex> guard(state.lock);
+            if (!state.error) {
+                state.error = std::current_exception();
+            }
+            state.stopped = true;
+        }
+
+        std::lock_guard<std::mutex> guard(state.lock);
+        state.active--;
+        if (state.stopped || state.Done()) {
+            state.work_cv.notify_all();
+            state.rows_cv.notify_all();
+        }
+    }
+}
+
+static unique_ptr<GlobalTableFunctionState> NotionBlocksInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<NotionBlocksBindData>();
+    auto state = make_uniq<NotionBlocksGlobalState>();
+    state->auth_token = bind_data.auth_token;
+    state->database_options = bind_data.database_options;
+    state->tasks.push_back({bind_data.root_id, bind_data.is_database ? "" : bind_data.root_id, 0,
+                            bind_data.is_database});
+    for (idx_t i = 0; i < bind_data.concurrency; i++) {
+        state->workers.emplace_back(RunWorker, std::ref(*state));
+    }
+    return std::move(state);
+}
+
+static void NotionBlocksFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &state = data_p.global_state->Cast<NotionBlocksGlobalState>();
+    std::unique_lock<std::mutex> guard(state.lock);
+    state.rows_cv.wait(guard, [&]() { return !state.rows.empty() || state.error || state.Done(); });
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+
+    auto page_ids = FlatVector::GetData<string_t>(output.data[0]);
+    auto block_ids = FlatVector::GetData<string_t>(output.data[1]);
+    auto parent_ids = FlatVector::GetData<string_t>(output.data[2]);
+    auto depths = FlatVector::GetData<int32_t>(output.data[3]);
+    auto positions = FlatVector::GetData<int32_t>(output.data[4]);
+    auto types = FlatVector::GetData<string_t>(output.data[5]);
+    auto texts = FlatVector::GetData<string_t>(output.data[6]);
+    auto has_children = FlatVector::GetData<bool>(output.data[7]);
+    idx_t count = 0;
+    while (!state.rows.empty() && count < STANDARD_VECTOR_SIZE) {
+        auto row = std::move(state.rows.front());
+        state.rows.pop_front();
+        page_ids[count] = StringVector::AddString(output.data[0], row.page_id);
+        block_ids[count] = StringVector::AddString(output.data[1], row.block_id);
+        parent_ids[count] = StringVector::AddString(output.data[2], row.parent_id);
+        depths[count] = row.depth;
+        positions[count] = row.position;
+        types[count] = StringVector::AddString(output.data[5], row.type);
+        if (row.has_text) {
+            texts[count] = StringVector::AddString(output.data[6], row.plain_text);
+        } else {
+            FlatVector::SetNull(output.data[6], count, true);
+        }
+        has_children[count] = row.has_children;
+        count++;
+    }
+    output.SetCardinality(count);
+    // Make room for workers waiting on a full buffer
+    state.rows_cv.notify_all();
+}
+
+void NotionBlocks::RegisterTableFunction(DatabaseInstance &db) {
+    TableFunction read_notion_blocks("read_notion_blocks", {LogicalType::VARCHAR}, NotionBlocksFunction,
+                                     NotionBlocksBind, NotionBlocksInit);
+    ExtensionUtil::RegisterFunction(db, read_notion_blocks);
+}
+
+} // namespace duckdb
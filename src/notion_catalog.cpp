@@ -0,0 +1,449 @@
+#include "notion_catalog.hpp"
+#include "notion_auth.hpp"
+#include "notion_decoder.hpp"
+#include "notion_json.hpp"
+#include "notion_page_stream.hpp"
+#include "notion_read.hpp"
+#include "notion_requests.hpp"
+#include "notion_schema_cache.hpp"
+#include "notion_utils.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/parser/parsed_data/attach_info.hpp"
+#include "duckdb/parser/parsed_data/create_schema_info.hpp"
+#include "duckdb/parser/parsed_data/create_table_info.hpp"
+#include "duckdb/storage/database_size.hpp"
+
+namespace duckdb {
+
+static constexpr const char *NOTION_SCHEMA_NAME = "main";
+
+static void ThrowReadOnly() {
+    throw BinderException("Attached Notion workspaces are read-only; write with COPY ... TO '<database id>' "
+                          "(FORMAT notion)");
+}
+
+NotionTableEntry::NotionTableEntry(Catalog &catalog, SchemaCatalogEntry &schema, CreateTableInfo &info,
+                                   std::string database_id_p, vector<NotionColumn> columns_p)
+    : TableCatalogEntry(catalog, schema, info), database_id(std::move(database_id_p)), columns(std::move(columns_p)) {
+}
+
+unique_ptr<BaseStatistics> NotionTableEntry::GetStatistics(ClientContext &context, column_t column_id) {
+    return nullptr;
+}
+
+TableFunction NotionTableEntry::GetScanFunction(ClientContext &context, unique_ptr<FunctionData> &bind_data) {
+    // The columns are already known, so binding a scan costs no schema request
+    bind_data = NotionRead::BindTable(context, database_id, columns);
+    return NotionRead::GetFunction();
+}
+
+TableStorageInfo NotionTableEntry::GetStorageInfo(ClientContext &context) {
+    return TableStorageInfo();
+}
+
+NotionSchemaEntry::NotionSchemaEntry(Catalog &catalog, CreateSchemaInfo &info) : SchemaCatalogEntry(catalog, info) {
+}
+
+// A database found by the workspace search
+struct NotionSearchResult {
+    std::string object;
+    std::string id;
+    // Id of the parent database, for data sources
+    std::string database_id;
+    std::string title;
+    bool in_trash = false;
+};
+
+static NotionSearchResult ParseSearchResult(const char *data, idx_t size) {
+    NotionSearchResult result;
+    NotionJsonCursor cursor(data, size);
+    if (!cursor.EnterObject()) {
+        return result;
+    }
+    NotionJsonString key;
+    while (cursor.NextKey(key)) {
+        NotionJsonString text;
+        if (key.Equals("object")) {
+            if (cursor.ReadString(text)) {
+                result.object = text.ToString();
+            }
+        } else if (key.Equals("id")) {
+            if (cursor.ReadString(text)) {
+                result.id = text.ToString();
+            }
+        } else if (key.Equals("title")) {
+            NotionPageDecoder::ReadRichText(cursor, result.title);
+        } else if (key.Equals("in_trash") || key.Equals("archived")) {
+            bool flag;
+            if (cursor.ReadBoolean(flag) && flag) {
+                result.in_trash = true;
+            }
+        } else if (key.Equals("parent")) {
+            if (!cursor.EnterObject()) {
+                continue;
+            }
+            NotionJsonString parent_key;
+            while (cursor.NextKey(parent_key)) {
+                if (parent_key.Equals("database_id") && cursor.ReadString(text)) {
+                    result.database_id = text.ToString();
+                } else if (!parent_key.Equals("database_id")) {
+                    cursor.SkipValue();
+                }
+            }
+        } else {
+            cursor.SkipValue();
+        }
+    }
+    return result;
+}
+
+void NotionSchemaEntry::AddTable(const std::string &title, const std::string &database_id,
+                                 vector<NotionColumn> columns) {
+    for (const auto &table : tables) {
+        if (table.second.database_id == database_id) {
+            // A database with several data sources is listed once per source
+            return;
+        }
+    }
+    // Tables are named after the database title; the id tells apart databases without one or
+    // with the same title
+    auto name = title.empty() ? database_id : title;
+    if (tables.find(name) != tables.end()) {
+        name += "_" + database_id.substr(0, 8);
+    }
+    NotionTableInfo info;
+    info.database_id = database_id;
+    info.columns = std::move(columns);
+    tables[name] = std::move(info);
+}
+
+void NotionSchemaEntry::ListTables(ClientContext &context, bool refresh) {
+    auto now = std::chrono::steady_clock::now();
+    if (listed && (!refresh || now - listed_at < NotionSchemaCache::GetTTL(context))) {
+        return;
+    }
+    // Tables are only added once every search page was read: a failed listing changes nothing
+    // and is tried again by the next lookup
+    struct ListedTable {
+        std::string title;
+        std::string database_id;
+        vector<NotionColumn> columns;
+    };
+    vector<ListedTable> listed_tables;
+    auto auth_token = NotionAuth::GetAuthToken(context);
+    std::string cursor;
+    do {
+        auto response = NotionRequests::Search(auth_token, "data_source", cursor);
+        if (!response.success) {
+            throw IOException("Failed to list the databases of the Notion workspace: " + response.body);
+        }
+        auto page = NotionPageStream::ParseResponse(std::move(response.body));
+        for (const auto &span : page.results) {
+            auto data = page.body.data() + span.offset;
+            auto result = ParseSearchResult(data, span.length);
+            auto database_id = result.object == "data_source" ? result.database_id : result.id;
+            if (result.in_trash || database_id.empty()) {
+                continue;
+            }
+            // Search results describe the properties, which spares a schema request per table
+            auto properties = NotionSchema::ParseProperties(std::string(data, span.length));
+            vector<NotionColumn> columns;
+            if (!properties.empty()) {
+                columns = NotionSchema::GetColumns(properties);
+            }
+            listed_tables.push_back({result.title, NotionUtils::ExtractDatabaseId(database_id), std::move(columns)});
+        }
+        cursor = page.has_more ? page.next_cursor : "";
+    } while (!cursor.empty());
+    for (auto &table : listed_tables) {
+        AddTable(table.title, table.database_id, std::move(table.columns));
+    }
+    listed = true;
+    listed_at = now;
+}
+
+void NotionSchemaEntry::LoadTables(ClientContext &context, const vector<std::string> &names) {
+    vector<std::string> missing_names;
+    vector<std::string> missing_ids;
+    for (const auto &name : names) {
+        auto &info = tables[name];
+        if (!info.entry && info.columns.empty()) {
+            missing_names.push_back(name);
+            missing_ids.push_back(info.database_id);
+        }
+    }
+    if (!missing_ids.empty()) {
+        auto auth_token = NotionAuth::GetAuthToken(context);
+        auto responses = NotionSchemaCache::Get(context).GetDatabases(context, missing_ids, auth_token);
+        for (idx_t i = 0; i < responses.size(); i++) {
+            if (!responses[i].success) {
+                throw IOException("Failed to get Notion database schema: " + responses[i].body);
+            }
+            tables[missing_names[i]].columns =
+                NotionSchema::GetColumns(NotionSchema::ParseProperties(responses[i].body));
+        }
+    }
+
+    for (const auto &name : names) {
+        auto &info = tables[name];
+        if (info.entry) {
+            continue;
+        }
+        CreateTableInfo create_info(ParentCatalog().GetName(), this->name, name);
+        for (const auto &column : info.columns) {
+            create_info.columns.AddColumn(ColumnDefinition(column.name, column.logical_type));
+        }
+        info.entry = make_uniq<NotionTableEntry>(ParentCatalog(), *this, create_info, info.database_id, info.columns);
+    }
+}
+
+void NotionSchemaEntry::Scan(ClientContext &context, CatalogType type,
+                             const std::function<void(CatalogEntry &)> &callback) {
+    if (type != CatalogType::TABLE_ENTRY) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    ListTables(context);
+    vector<std::string> names;
+    for (const auto &table : tables) {
+        names.push_back(table.first);
+    }
+    LoadTables(context, names);
+    for (auto &table : tables) {
+        callback(*table.second.entry);
+    }
+}
+
+void NotionSchemaEntry::Scan(CatalogType type, const std::function<void(CatalogEntry &)> &callback) {
+    if (type != CatalogType::TABLE_ENTRY) {
+        return;
+    }
+    // Without a client context, only the tables loaded so far are visible
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto &table : tables) {
+        if (table.second.entry) {
+            callback(*table.second.entry);
+        }
+    }
+}
+
+optional_ptr<CatalogEntry> NotionSchemaEntry::GetEntry(CatalogTransaction transaction, CatalogType type,
+                                                       const string &name) {
+    if (type != CatalogType::TABLE_ENTRY) {
+        return nullptr;
+    }
+    auto &context = transaction.GetContext();
+    std::lock_guard<std::mutex> guard(lock);
+    ListTables(context);
+
+    auto table = tables.find(name);
+    if (table == tables.end()) {
+        ListTables(context, true);
+        table = tables.find(name);
+    }
+    if (table == tables.end()) {
+        // Tables can also be named by database id, including databases the search did not list
+        auto database_id = NotionUtils::ExtractDatabaseId(name);
+        for (auto &entry : tables) {
+            if (entry.second.database_id == database_id) {
+                LoadTables(context, {entry.first});
+                return entry.second.entry.get();
+            }
+        }
+        if (database_id.size() != 32) {
+            return nullptr;
+        }
+        auto response =
+            NotionSchemaCache::Get(context).GetDatabase(context, database_id, NotionAuth::GetAuthToken(context));
+        if (response.status_code == 404) {
+            return nullptr;
+        }
+        if (!response.success) {
+            throw IOException("Failed to get Notion database schema: " + response.body);
+        }
+        NotionTableInfo info;
+        info.database_id = database_id;
+        info.columns = NotionSchema::GetColumns(NotionSchema::ParseProperties(response.body));
+        table = tables.emplace(name, std::move(info)).first;
+    }
+    LoadTables(context, {table->first});
+    return table->second.entry.get();
+}
+
+optional_ptr<CatalogEntry> NotionSchemaEntry::CreateIndex(CatalogTransaction transaction, CreateIndexInfo &info,
+                                                          TableCatalogEntry &table) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+optional_ptr<CatalogEntry> NotionSchemaEntry::CreateFunction(CatalogTransaction transaction,
+                                                             CreateFunctionInfo &info) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+optional_ptr<CatalogEntry> NotionSchemaEntry::CreateTable(CatalogTransaction transaction, BoundCreateTableInfo &info) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+optional_ptr<CatalogEntry> NotionSchemaEntry::CreateView(CatalogTransaction transaction, CreateViewInfo &info) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+optional_ptr<CatalogEntry> NotionSchemaEntry::CreateSequence(CatalogTransaction transaction,
+                                                             CreateSequenceInfo &info) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+optional_ptr<CatalogEntry> NotionSchemaEntry::CreateTableFunction(CatalogTransaction transaction,
+                                                                  CreateTableFunctionInfo &info) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+optional_ptr<CatalogEntry> NotionSchemaEntry::CreateCopyFunction(CatalogTransaction transaction,
+                                                                 CreateCopyFunctionInfo &info) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+optional_ptr<CatalogEntry> NotionSchemaEntry::CreatePragmaFunction(CatalogTransaction transaction,
+                                                                   CreatePragmaFunctionInfo &info) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+optional_ptr<CatalogEntry> NotionSchemaEntry::CreateCollation(CatalogTransaction transaction,
+                                                              CreateCollationInfo &info) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+optional_ptr<CatalogEntry> NotionSchemaEntry::CreateType(CatalogTransaction transaction, CreateTypeInfo &info) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+void NotionSchemaEntry::DropEntry(ClientContext &context, DropInfo &info) {
+    ThrowReadOnly();
+}
+
+void NotionSchemaEntry::Alter(CatalogTransaction transaction, AlterInfo &info) {
+    ThrowReadOnly();
+}
+
+NotionCatalog::NotionCatalog(AttachedDatabase &db, std::string path_p) : Catalog(db), path(std::move(path_p)) {
+}
+
+void NotionCatalog::Initialize(bool load_builtin) {
+    CreateSchemaInfo info;
+    info.schema = NOTION_SCHEMA_NAME;
+    main_schema = make_uniq<NotionSchemaEntry>(*this, info);
+}
+
+void NotionCatalog::ScanSchemas(ClientContext &context, std::function<void(SchemaCatalogEntry &)> callback) {
+    callback(*main_schema);
+}
+
+optional_ptr<SchemaCatalogEntry> NotionCatalog::GetSchema(CatalogTransaction transaction, const string &schema_name,
+                                                          OnEntryNotFound if_not_found,
+                                                          QueryErrorContext error_context) {
+    if (StringUtil::CIEquals(schema_name, NOTION_SCHEMA_NAME)) {
+        return main_schema.get();
+    }
+    if (if_not_found == OnEntryNotFound::RETURN_NULL) {
+        return nullptr;
+    }
+    throw BinderException("Notion workspace \"%s\" has no schema \"%s\"; its databases are in \"%s\"", GetName(),
+                          schema_name, NOTION_SCHEMA_NAME);
+}
+
+optional_ptr<CatalogEntry> NotionCatalog::CreateSchema(CatalogTransaction transaction, CreateSchemaInfo &info) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+unique_ptr<PhysicalOperator> NotionCatalog::PlanCreateTableAs(ClientContext &context, LogicalCreateTable &op,
+                                                              unique_ptr<PhysicalOperator> plan) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+unique_ptr<PhysicalOperator> NotionCatalog::PlanInsert(ClientContext &context, LogicalInsert &op,
+                                                       unique_ptr<PhysicalOperator> plan) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+unique_ptr<PhysicalOperator> NotionCatalog::PlanDelete(ClientContext &context, LogicalDelete &op,
+                                                       unique_ptr<PhysicalOperator> plan) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+unique_ptr<PhysicalOperator> NotionCatalog::PlanUpdate(ClientContext &context, LogicalUpdate &op,
+                                                       unique_ptr<PhysicalOperator> plan) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+unique_ptr<LogicalOperator> NotionCatalog::BindCreateIndex(Binder &binder, CreateStatement &stmt,
+                                                           TableCatalogEntry &table,
+                                                           unique_ptr<LogicalOperator> plan) {
+    ThrowReadOnly();
+    return nullptr;
+}
+
+DatabaseSize NotionCatalog::GetDatabaseSize(ClientContext &context) {
+    // Nothing is stored locally
+    return DatabaseSize();
+}
+
+void NotionCatalog::DropSchema(ClientContext &context, DropInfo &info) {
+    ThrowReadOnly();
+}
+
+Transaction &NotionTransactionManager::StartTransaction(ClientContext &context) {
+    auto transaction = make_uniq<NotionTransaction>(*this, context);
+    auto &result = *transaction;
+    std::lock_guard<std::mutex> guard(lock);
+    transactions[&result] = std::move(transaction);
+    return result;
+}
+
+ErrorData NotionTransactionManager::CommitTransaction(ClientContext &context, Transaction &transaction) {
+    std::lock_guard<std::mutex> guard(lock);
+    transactions.erase(&transaction);
+    return ErrorData();
+}
+
+void NotionTransactionManager::RollbackTransaction(Transaction &transaction) {
+    std::lock_guard<std::mutex> guard(lock);
+    transactions.erase(&transaction);
+}
+
+void NotionTransactionManager::Checkpoint(ClientContext &context, bool force) {
+}
+
+static unique_ptr<Catalog> NotionAttach(StorageExtensionInfo *storage_info, ClientContext &context,
+                                        AttachedDatabase &db, const string &name, AttachInfo &info,
+                                        AccessMode access_mode) {
+    // The workspace is the one the integration token grants access to; the path is only informative
+    return make_uniq<NotionCatalog>(db, info.path);
+}
+
+static unique_ptr<TransactionManager> NotionCreateTransactionManager(StorageExtensionInfo *storage_info,
+                                                                     AttachedDatabase &db, Catalog &catalog) {
+    return make_uniq<NotionTransactionManager>(db);
+}
+
+NotionStorageExtension::NotionStorageExtension() {
+    attach = NotionAttach;
+    create_transaction_manager = NotionCreateTransactionManager;
+}
+
+} // namespace duckdb
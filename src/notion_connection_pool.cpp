@@ -0,0 +1,198 @@
+#include "notion_connection_pool.hpp"
+#include "notion_utils.hpp"
+#include "duckdb/main/config.hpp"
+#include <openssl/bio.h>
+#include <unistd.h>
+
+namespace duckdb {
+
+NotionConnection::~NotionConnection() {
+    if (bio) {
+        BIO_free_all(bio);
+        return;
+    }
+    if (ssl) {
+        SSL_free(ssl);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// The pool is intentionally never destroyed: tearing down SSL objects during static
+// destruction can race with OpenSSL's own atexit cleanup.
+static NotionConnectionPool *pool_instance = nullptr;
+static std::once_flag pool_init_flag;
+
+NotionConnectionPool::NotionConnectionPool() {
+    ctx = SSL_CTX_new(TLS_client_method());
+    if (ctx) {
+        // Let OpenSSL hand us resumable client sessions
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT);
+    }
+}
+
+void NotionConnectionPool::Initialize() {
+    std::call_once(pool_init_flag, []() { pool_instance = new NotionConnectionPool(); });
+}
+
+NotionConnectionPool &NotionConnectionPool::Get() {
+    Initialize();
+    return *pool_instance;
+}
+
+void NotionConnectionPool::SetPoolSize(ClientContext &context, SetScope scope, Value &parameter) {
+    NotionUtils::CheckGlobalScope(scope, "notion_pool_size");
+    auto &pool = Get();
+    std::lock_guard<std::mutex> guard(pool.lock);
+    pool.max_idle_connections = parameter.GetValue<uint64_t>();
+    while (pool.idle_connections.size() > pool.max_idle_connections) {
+        pool.idle_connections.erase(pool.idle_connections.begin());
+    }
+}
+
+void NotionConnectionPool::SetIdleTimeout(ClientContext &context, SetScope scope, Value &parameter) {
+    NotionUtils::CheckGlobalScope(scope, "notion_pool_idle_timeout");
+    auto &pool = Get();
+    std::lock_guard<std::mutex> guard(pool.lock);
+    pool.idle_timeout = std::chrono::seconds(parameter.GetValue<uint64_t>());
+    pool.EvictIdle();
+}
+
+void NotionConnectionPool::EvictIdle() {
+    auto now = std::chrono::steady_clock::now();
+    for (idx_t i = idle_connections.size(); i > 0; i--) {
+        if (now - idle_connections[i - 1]->last_used >= idle_timeout) {
+            idle_connections.erase(idle_connections.begin() + (i - 1));
+        }
+    }
+}
+
+unique_ptr<NotionConnection> NotionConnectionPool::AcquireIdle(const std::string &host, bool secure,
+                                                               bool nonblocking) {
+    std::lock_guard<std::mutex> guard(lock);
+    EvictIdle();
+    // Most recently used connections sit at the back and are the least likely to be closed
+    for (idx_t i = idle_connections.size(); i > 0; i--) {
+        auto &idle = idle_connections[i - 1];
+        if (idle->host == host && idle->secure == secure && (idle->bio == nullptr) == nonblocking) {
+            auto connection = std::move(idle);
+            idle_connections.erase(idle_connections.begin() + (i - 1));
+            connection->reused = true;
+            return connection;
+        }
+    }
+    return nullptr;
+}
+
+unique_ptr<NotionConnection> NotionConnectionPool::Acquire(const std::string &host, bool secure,
+                                                           std::string &error) {
+    auto connection = AcquireIdle(host, secure, false);
+    if (connection) {
+        return connection;
+    }
+    return Connect(host, secure, error);
+}
+
+SSL *NotionConnectionPool::NewSsl(const std::string &host) {
+    if (!ctx) {
+        return nullptr;
+    }
+    auto ssl = SSL_new(ctx);
+    if (!ssl) {
+        return nullptr;
+    }
+    // Writes may be retried from a different buffer position after SSL_ERROR_WANT_WRITE
+    SSL_set_mode(ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    SSL_set_tlsext_host_name(ssl, host.substr(0, host.find(':')).c_str());
+
+    std::lock_guard<std::mutex> guard(lock);
+    auto entry = sessions.find(host);
+    if (entry != sessions.end()) {
+        SSL_set_session(ssl, entry->second);
+    }
+    return ssl;
+}
+
+unique_ptr<NotionConnection> NotionConnectionPool::Connect(const std::string &host, bool secure, std::string &error) {
+    auto connection = make_uniq<NotionConnection>();
+    connection->host = host;
+    connection->secure = secure;
+    bool has_port = host.find(':') != std::string::npos;
+
+    if (!secure) {
+        connection->bio = BIO_new_connect((has_port ? host : host + ":80").c_str());
+        if (!connection->bio || BIO_do_connect(connection->bio) <= 0) {
+            error = "Failed to connect to Notion API";
+            return nullptr;
+        }
+        connection->last_used = std::chrono::steady_clock::now();
+        return connection;
+    }
+
+    if (!ctx) {
+        error = "Failed to create SSL context";
+        return nullptr;
+    }
+
+    // Create BIO connection
+    connection->bio = BIO_new_ssl_connect(ctx);
+    if (!connection->bio) {
+        error = "Failed to create BIO";
+        return nullptr;
+    }
+
+    // Set up connection
+    BIO_set_conn_hostname(connection->bio, (has_port ? host : host + ":443").c_str());
+    BIO_get_ssl(connection->bio, &connection->ssl);
+    SSL_set_mode(connection->ssl, SSL_MODE_AUTO_RETRY);
+    SSL_set_tlsext_host_name(connection->ssl, host.substr(0, host.find(':')).c_str());
+
+    // Resume the last TLS session for this host to skip the full handshake
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto entry = sessions.find(host);
+        if (entry != sessions.end()) {
+            SSL_set_session(connection->ssl, entry->second);
+        }
+    }
+
+    // Connect and perform the TLS handshake
+    if (BIO_do_connect(connection->bio) <= 0) {
+        error = "Failed to connect to Notion API";
+        return nullptr;
+    }
+
+    connection->last_used = std::chrono::steady_clock::now();
+    return connection;
+}
+
+void NotionConnectionPool::Release(unique_ptr<NotionConnection> connection, bool reusable) {
+    if (!connection) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    // Remember the session (TLS 1.3 tickets only arrive after the handshake) for resumption
+    SSL_SESSION *session = connection->ssl ? SSL_get1_session(connection->ssl) : nullptr;
+    if (session) {
+        if (SSL_SESSION_is_resumable(session)) {
+            auto entry = sessions.find(connection->host);
+            if (entry != sessions.end()) {
+                SSL_SESSION_free(entry->second);
+            }
+            sessions[connection->host] = session;
+        } else {
+            SSL_SESSION_free(session);
+        }
+    }
+
+    if (!reusable || idle_connections.size() >= max_idle_connections) {
+        return;
+    }
+    connection->last_used = std::chrono::steady_clock::now();
+    idle_connections.push_back(std::move(connection));
+}
+
+} // namespace duckdb
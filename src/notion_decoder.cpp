@@ -0,0 +1,374 @@
+#include "notion_decoder.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+
+namespace duckdb {
+
+NotionPageDecoder::NotionPageDecoder(const vector<NotionColumn> &columns, const vector<idx_t> &column_ids) {
+    for (idx_t output_idx = 0; output_idx < column_ids.size(); output_idx++) {
+        if (column_ids[output_idx] >= columns.size()) {
+            // Virtual columns such as the row id are not decoded and stay NULL
+            types.push_back(NotionPropertyType::OTHER);
+            continue;
+        }
+        const auto &column = columns[column_ids[output_idx]];
+        types.push_back(column.type);
+        if (column.is_property) {
+            properties[column.key] = output_idx;
+        } else {
+            page_fields[column.key] = output_idx;
+        }
+    }
+}
+
+bool NotionPageDecoder::ReadRichText(NotionJsonCursor &cursor, std::string &result) {
+    bool has_text = false;
+    if (!cursor.EnterArray()) {
+        return false;
+    }
+    while (cursor.NextElement()) {
+        if (!cursor.EnterObject()) {
+            continue;
+        }
+        NotionJsonString key;
+        while (cursor.NextKey(key)) {
+            if (!key.Equals("plain_text")) {
+                cursor.SkipValue();
+                continue;
+            }
+            NotionJsonString text;
+            if (cursor.ReadString(text)) {
+                text.AppendTo(result);
+                has_text = true;
+            }
+        }
+    }
+    return has_text;
+}
+
+// Reads a string member (e.g. "name" of a select option) of the object at the cursor
+static bool ReadObjectString(NotionJsonCursor &cursor, const char *member, NotionJsonString &result) {
+    if (!cursor.EnterObject()) {
+        return false;
+    }
+    bool found = false;
+    NotionJsonString key;
+    while (cursor.NextKey(key)) {
+        if (key.Equals(member)) {
+            found = cursor.ReadString(result);
+        } else {
+            cursor.SkipValue();
+        }
+    }
+    return found;
+}
+
+void NotionPageDecoder::WriteString(Vector &vector, idx_t row, const NotionJsonString &text) {
+    string_t result;
+    if (text.has_escapes) {
+        text_buffer.clear();
+        text.AppendTo(text_buffer);
+        result = StringVector::AddString(vector, text_buffer);
+    } else {
+        result = StringVector::AddString(vector, text.data, text.size);
+    }
+    FlatVector::GetData<string_t>(vector)[row] = result;
+    FlatVector::Validity(vector).SetValid(row);
+}
+
+void NotionPageDecoder::WriteTimestamp(Vector &vector, idx_t row, const NotionJsonString &text) {
+    timestamp_t result;
+    if (Timestamp::TryConvertTimestamp(text.data, text.size, result) != TimestampCastResult::SUCCESS) {
+        return;
+    }
+    FlatVector::GetData<timestamp_t>(vector)[row] = result;
+    FlatVector::Validity(vector).SetValid(row);
+}
+
+bool NotionPageDecoder::WriteEnum(Vector &vector, idx_t row, const NotionJsonString &text) {
+    string_t label(text.data, static_cast<uint32_t>(text.size));
+    if (text.has_escapes) {
+        text_buffer.clear();
+        text.AppendTo(text_buffer);
+        label = string_t(text_buffer.data(), static_cast<uint32_t>(text_buffer.size()));
+    }
+    auto code = EnumType::GetPos(vector.GetType(), label);
+    if (code < 0) {
+        // The option was added or renamed after the schema was read
+        unknown_options = true;
+        return false;
+    }
+    switch (vector.GetType().InternalType()) {
+    case PhysicalType::UINT8:
+        FlatVector::GetData<uint8_t>(vector)[row] = static_cast<uint8_t>(code);
+        break;
+    case PhysicalType::UINT16:
+        FlatVector::GetData<uint16_t>(vector)[row] = static_cast<uint16_t>(code);
+        break;
+    default:
+        FlatVector::GetData<uint32_t>(vector)[row] = static_cast<uint32_t>(code);
+        break;
+    }
+    FlatVector::Validity(vector).SetValid(row);
+    return true;
+}
+
+void NotionPageDecoder::AppendListString(Vector &vector, idx_t row, const NotionJsonString &text) {
+    auto list_size = ListVector::GetListSize(vector);
+    ListVector::Reserve(vector, list_size + 1);
+    auto &child = ListVector::GetEntry(vector);
+    if (child.GetType().id() == LogicalTypeId::ENUM) {
+        if (!WriteEnum(child, list_size, text)) {
+            // Unknown options are left out of the list
+            return;
+        }
+    } else if (text.has_escapes) {
+        text_buffer.clear();
+        text.AppendTo(text_buffer);
+        FlatVector::GetData<string_t>(child)[list_size] = StringVector::AddString(child, text_buffer);
+    } else {
+        FlatVector::GetData<string_t>(child)[list_size] = StringVector::AddString(child, text.data, text.size);
+    }
+    ListVector::SetListSize(vector, list_size + 1);
+    FlatVector::GetData<list_entry_t>(vector)[row].length++;
+}
+
+void NotionPageDecoder::DecodeValue(NotionJsonCursor &cursor, NotionPropertyType type, Vector &vector, idx_t row) {
+    NotionJsonString text;
+    switch (type) {
+    case NotionPropertyType::PAGE_ID:
+    case NotionPropertyType::URL:
+    case NotionPropertyType::EMAIL:
+    case NotionPropertyType::PHONE_NUMBER:
+        if (cursor.ReadString(text)) {
+            WriteString(vector, row, text);
+        }
+        break;
+    case NotionPropertyType::TITLE:
+    case NotionPropertyType::RICH_TEXT:
+        text_buffer.clear();
+        if (ReadRichText(cursor, text_buffer)) {
+            FlatVector::GetData<string_t>(vector)[row] = StringVector::AddString(vector, text_buffer);
+            FlatVector::Validity(vector).SetValid(row);
+        }
+        break;
+    case NotionPropertyType::NUMBER: {
+        double number;
+        if (cursor.ReadNumber(number)) {
+            FlatVector::GetData<double>(vector)[row] = number;
+            FlatVector::Validity(vector).SetValid(row);
+        }
+        break;
+    }
+    case NotionPropertyType::CHECKBOX: {
+        bool checked;
+        if (cursor.ReadBoolean(checked)) {
+            FlatVector::GetData<bool>(vector)[row] = checked;
+            FlatVector::Validity(vector).SetValid(row);
+        }
+        break;
+    }
+    case NotionPropertyType::SELECT:
+    case NotionPropertyType::STATUS:
+        if (!ReadObjectString(cursor, "name", text)) {
+            break;
+        }
+        if (vector.GetType().id() == LogicalTypeId::ENUM) {
+            WriteEnum(vector, row, text);
+        } else {
+            WriteString(vector, row, text);
+        }
+        break;
+    case NotionPropertyType::CREATED_BY:
+    case NotionPropertyType::LAST_EDITED_BY:
+        if (ReadObjectString(cursor, "id", text)) {
+            WriteString(vector, row, text);
+        }
+        break;
+    case NotionPropertyType::DATE:
+        if (ReadObjectString(cursor, "start", text)) {
+            WriteTimestamp(vector, row, text);
+        }
+        break;
+    case NotionPropertyType::CREATED_TIME:
+    case NotionPropertyType::LAST_EDITED_TIME:
+        if (cursor.ReadString(text)) {
+            WriteTimestamp(vector, row, text);
+        }
+        break;
+    case NotionPropertyType::MULTI_SELECT:
+    case NotionPropertyType::RELATION:
+    case NotionPropertyType::PEOPLE: {
+        if (!cursor.EnterArray()) {
+            break;
+        }
+        auto &entry = FlatVector::GetData<list_entry_t>(vector)[row];
+        entry.offset = ListVector::GetListSize(vector);
+        entry.length = 0;
+        FlatVector::Validity(vector).SetValid(row);
+        // Options are listed by name, related pages by id and people by name when it is shared
+        bool by_id = type == NotionPropertyType::RELATION || (people_ids && type == NotionPropertyType::PEOPLE);
+        const char *member = by_id ? "id" : "name";
+        while (cursor.NextElement()) {
+            NotionJsonString id;
+            bool found = false;
+            if (!cursor.EnterObject()) {
+                continue;
+            }
+            NotionJsonString key;
+            while (cursor.NextKey(key)) {
+                if (key.Equals(member)) {
+                    found = cursor.ReadString(text);
+                } else if (key.Equals("id")) {
+                    cursor.ReadString(id);
+                } else {
+                    cursor.SkipValue();
+                }
+            }
+            if (found) {
+                AppendListString(vector, row, text);
+            } else if (id.data) {
+                AppendListString(vector, row, id);
+            }
+        }
+        break;
+    }
+    case NotionPropertyType::UNIQUE_ID: {
+        // {"prefix": "TASK", "number": 12} is rendered as TASK-12
+        if (!cursor.EnterObject()) {
+            break;
+        }
+        NotionJsonString prefix;
+        double number;
+        bool has_number = false;
+        NotionJsonString key;
+        while (cursor.NextKey(key)) {
+            if (key.Equals("prefix")) {
+                cursor.ReadString(prefix);
+            } else if (key.Equals("number")) {
+                has_number = cursor.ReadNumber(number);
+            } else {
+                cursor.SkipValue();
+            }
+        }
+        if (has_number) {
+            text_buffer.clear();
+            if (prefix.data) {
+                prefix.AppendTo(text_buffer);
+                text_buffer += "-";
+            }
+            text_buffer += std::to_string(static_cast<int64_t>(number));
+            FlatVector::GetData<string_t>(vector)[row] = StringVector::AddString(vector, text_buffer);
+            FlatVector::Validity(vector).SetValid(row);
+        }
+        break;
+    }
+    case NotionPropertyType::FORMULA: {
+        // {"type": "number", "number": 3}: render the result as text
+        if (!cursor.EnterObject()) {
+            break;
+        }
+        NotionJsonString key;
+        while (cursor.NextKey(key)) {
+            if (key.Equals("type")) {
+                cursor.SkipValue();
+                continue;
+            }
+            auto value_type = cursor.Peek();
+            if (value_type == NotionJsonType::STRING) {
+                if (cursor.ReadString(text)) {
+                    WriteString(vector, row, text);
+                }
+            } else if (value_type == NotionJsonType::OBJECT) {
+                if (ReadObjectString(cursor, "start", text)) {
+                    WriteString(vector, row, text);
+                }
+            } else if (value_type == NotionJsonType::NUMBER || value_type == NotionJsonType::BOOLEAN) {
+                idx_t start, end;
+                cursor.SkipValue(start, end);
+                text.data = page_data + start;
+                text.size = end - start;
+                text.has_escapes = false;
+                WriteString(vector, row, text);
+            } else {
+                cursor.SkipValue();
+            }
+        }
+        break;
+    }
+    default: {
+        // Unsupported property types are returned as their raw JSON value
+        if (cursor.Peek() == NotionJsonType::NULL_VALUE) {
+            cursor.SkipValue();
+            break;
+        }
+        idx_t start, end;
+        cursor.SkipValue(start, end);
+        text.data = page_data + start;
+        text.size = end - start;
+        text.has_escapes = false;
+        WriteString(vector, row, text);
+        break;
+    }
+    }
+}
+
+void NotionPageDecoder::DecodeProperty(NotionJsonCursor &cursor, NotionPropertyType type, Vector &vector,
+                                       idx_t row) {
+    // {"id": "...", "type": "number", "number": 42}: the value sits under the type's name
+    if (!cursor.EnterObject()) {
+        return;
+    }
+    NotionJsonString key;
+    while (cursor.NextKey(key)) {
+        if (key.Equals("id") || key.Equals("type")) {
+            cursor.SkipValue();
+            continue;
+        }
+        DecodeValue(cursor, type, vector, row);
+    }
+}
+
+void NotionPageDecoder::Decode(const char *data, idx_t size, DataChunk &output, idx_t row) {
+    for (idx_t output_idx = 0; output_idx < types.size(); output_idx++) {
+        FlatVector::Validity(output.data[output_idx]).SetInvalid(row);
+    }
+
+    page_data = data;
+    NotionJsonCursor cursor(data, size);
+    if (!cursor.EnterObject()) {
+        return;
+    }
+
+    NotionJsonString key;
+    while (cursor.NextKey(key)) {
+        if (key.Equals("properties")) {
+            if (!cursor.EnterObject()) {
+                continue;
+            }
+            NotionJsonString property_name;
+            while (cursor.NextKey(property_name)) {
+                key_buffer.clear();
+                property_name.AppendTo(key_buffer);
+                auto entry = properties.find(key_buffer);
+                if (entry == properties.end()) {
+                    cursor.SkipValue();
+                    continue;
+                }
+                DecodeProperty(cursor, types[entry->second], output.data[entry->second], row);
+            }
+            continue;
+        }
+
+        key_buffer.clear();
+        key.AppendTo(key_buffer);
+        auto entry = page_fields.find(key_buffer);
+        if (entry == page_fields.end()) {
+            cursor.SkipValue();
+            continue;
+        }
+        DecodeValue(cursor, types[entry->second], output.data[entry->second], row);
+    }
+}
+
+} // namespace duckdb
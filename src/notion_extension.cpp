@@ -1,7 +1,20 @@
 #include "notion_extension.hpp"
 #include "notion_auth.hpp"
+#include "notion_blocks.hpp"
+#include "notion_catalog.hpp"
+#include "notion_connection_pool.hpp"
+#include "notion_page_cache.hpp"
+#include "notion_page_stream.hpp"
+#include "notion_rate_limiter.hpp"
 #include "notion_read.hpp"
+#include "notion_relations.hpp"
+#include "notion_requests.hpp"
+#include "notion_schema_cache.hpp"
+#include "notion_stats.hpp"
+#include "notion_sync.hpp"
+#include "notion_transport.hpp"
 #include "notion_write.hpp"
+#include "duckdb/main/config.hpp"
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 
@@ -15,12 +28,83 @@ void NotionExtension::Load(DuckDB &db) {
     SSL_library_init();
     OpenSSL_add_all_algorithms();
 
+    // Create the shared keep-alive connection pool used by all API requests
+    NotionConnectionPool::Initialize();
+
+    auto &config = DBConfig::GetConfig(db_instance);
+    config.AddExtensionOption("notion_pool_size",
+                              "Maximum number of idle keep-alive connections kept open to the Notion API",
+                              LogicalType::UBIGINT, Value::UBIGINT(NotionConnectionPool::DEFAULT_POOL_SIZE),
+                              NotionConnectionPool::SetPoolSize);
+    config.AddExtensionOption("notion_pool_idle_timeout",
+                              "Seconds an idle Notion API connection is kept open before it is closed",
+                              LogicalType::UBIGINT, Value::UBIGINT(NotionConnectionPool::DEFAULT_IDLE_TIMEOUT_SECONDS),
+                              NotionConnectionPool::SetIdleTimeout);
+    config.AddExtensionOption("notion_io_threads",
+                              "Number of event loop threads sending Notion API requests (0 sends them with blocking I/O on the calling threads)",
+                              LogicalType::UBIGINT, Value::UBIGINT(NotionTransport::DEFAULT_IO_THREADS),
+                              NotionTransport::SetIoThreads);
+    config.AddExtensionOption("notion_prefetch_depth",
+                              "Number of result pages read_notion fetches ahead in the background (0 disables prefetching)",
+                              LogicalType::UBIGINT, Value::UBIGINT(NotionPageStream::DEFAULT_PREFETCH_DEPTH));
+    config.AddExtensionOption("notion_scan_partitions",
+                              "Number of created_time ranges read_notion splits a scan into, each read by its own thread",
+                              LogicalType::UBIGINT, Value::UBIGINT(NotionRead::DEFAULT_SCAN_PARTITIONS));
+    config.AddExtensionOption("notion_relation_concurrency",
+                              "Number of related pages read_notion requests concurrently with expand_relations",
+                              LogicalType::UBIGINT, Value::UBIGINT(NotionRelationResolver::DEFAULT_CONCURRENCY));
+    config.AddExtensionOption("notion_block_concurrency",
+                              "Number of block child lists read_notion_blocks requests concurrently",
+                              LogicalType::UBIGINT, Value::UBIGINT(NotionBlocks::DEFAULT_CONCURRENCY));
+    config.AddExtensionOption("notion_copy_concurrency",
+                              "Number of page requests each COPY TO notion thread keeps in flight",
+                              LogicalType::UBIGINT, Value::UBIGINT(NOTION_DEFAULT_COPY_CONCURRENCY));
+    config.AddExtensionOption("notion_requests_per_second",
+                              "Average number of Notion API requests per second per integration token (0 disables the limit)",
+                              LogicalType::DOUBLE, Value::DOUBLE(NotionRateLimiter::DEFAULT_REQUESTS_PER_SECOND),
+                              NotionRateLimiter::SetDefaultRate);
+    config.AddExtensionOption("notion_max_retries",
+                              "Number of times a rate limited or transiently failed Notion API request is retried",
+                              LogicalType::UBIGINT, Value::UBIGINT(NotionRequests::DEFAULT_MAX_RETRIES),
+                              NotionRequests::SetMaxRetries);
+    config.AddExtensionOption("notion_api_base_url",
+                              "Base URL of the Notion API; http:// is allowed for local stand-in servers",
+                              LogicalType::VARCHAR, Value(NotionRequests::DEFAULT_API_BASE_URL),
+                              NotionRequests::SetBaseUrl);
+    config.AddExtensionOption("notion_schema_cache_ttl",
+                              "Seconds a Notion database schema is reused by later queries before it is requested again",
+                              LogicalType::UBIGINT, Value::UBIGINT(NotionSchemaCache::DEFAULT_TTL_SECONDS));
+    config.AddExtensionOption("notion_cache_directory",
+                              "Directory in which read_notion caches query results (empty disables the cache)",
+                              LogicalType::VARCHAR, Value(""));
+    config.AddExtensionOption("notion_cache_ttl",
+                              "Seconds a cached read_notion result is served before it is fetched again",
+                              LogicalType::UBIGINT, Value::UBIGINT(NotionPageCache::DEFAULT_TTL_SECONDS));
+
+    // ATTACH '' AS workspace (TYPE notion)
+    config.storage_extensions["notion"] = make_uniq<NotionStorageExtension>();
+
     // Register authentication/secret functions
     NotionAuth::RegisterSecretFunctions(db_instance);
 
     // Register table functions for reading
     NotionRead::RegisterTableFunction(db_instance);
 
+    // Register read_notion_blocks() for page content
+    NotionBlocks::RegisterTableFunction(db_instance);
+
+    // Register notion_cache_clear()
+    NotionPageCache::RegisterFunctions(db_instance);
+
+    // Register notion_schema_cache_clear()
+    NotionSchemaCache::RegisterFunctions(db_instance);
+
+    // Register notion_stats() and notion_stats_reset()
+    NotionStats::RegisterFunctions(db_instance);
+
+    // Register notion_sync() for incremental mirroring
+    NotionSync::RegisterTableFunction(db_instance);
+
     // Register copy function for writing
     NotionWrite::RegisterCopyFunction(db_instance);
 }
@@ -0,0 +1,308 @@
+#include "notion_filter.hpp"
+#include "notion_utils.hpp"
+#include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/filter/conjunction_filter.hpp"
+#include "duckdb/planner/filter/null_filter.hpp"
+#include "duckdb/planner/expression/bound_conjunction_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_reference_expression.hpp"
+#include "duckdb/common/types/date.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include <cmath>
+
+namespace duckdb {
+
+// Notion compares dates per day in the workspace time zone, so date bounds are widened
+// by this many days to never drop a page that matches the (UTC) timestamp filter
+static constexpr int32_t DATE_FILTER_MARGIN_DAYS = 2;
+
+// Name of the condition object for a property type, e.g. {"property": "Done", "checkbox": {...}}
+static const char *FilterTypeName(NotionPropertyType type) {
+    switch (type) {
+    case NotionPropertyType::TITLE:
+        return "title";
+    case NotionPropertyType::RICH_TEXT:
+        return "rich_text";
+    case NotionPropertyType::NUMBER:
+        return "number";
+    case NotionPropertyType::CHECKBOX:
+        return "checkbox";
+    case NotionPropertyType::SELECT:
+        return "select";
+    case NotionPropertyType::STATUS:
+        return "status";
+    case NotionPropertyType::MULTI_SELECT:
+        return "multi_select";
+    case NotionPropertyType::DATE:
+        return "date";
+    case NotionPropertyType::URL:
+        return "url";
+    case NotionPropertyType::EMAIL:
+        return "email";
+    case NotionPropertyType::PHONE_NUMBER:
+        return "phone_number";
+    case NotionPropertyType::PEOPLE:
+        return "people";
+    case NotionPropertyType::RELATION:
+        return "relation";
+    case NotionPropertyType::CREATED_TIME:
+        return "created_time";
+    case NotionPropertyType::LAST_EDITED_TIME:
+        return "last_edited_time";
+    default:
+        return nullptr;
+    }
+}
+
+static std::string MakeCondition(const NotionColumn &column, const char *type_name, const char *operation,
+                                 const std::string &operand) {
+    std::string condition = "{";
+    if (column.type == NotionPropertyType::CREATED_TIME || column.type == NotionPropertyType::LAST_EDITED_TIME) {
+        // Page timestamps are filtered with a timestamp condition rather than a property condition
+        condition += "\"timestamp\":\"";
+        condition += type_name;
+        condition += "\"";
+    } else {
+        condition += "\"property\":";
+        NotionUtils::AppendJsonString(condition, column.key);
+    }
+    condition += ",\"";
+    condition += type_name;
+    condition += "\":{\"";
+    condition += operation;
+    condition += "\":";
+    condition += operand;
+    condition += "}}";
+    return condition;
+}
+
+static std::string DateOperand(date_t date, int32_t offset_days) {
+    return "\"" + Date::ToString(date_t(date.days + offset_days)) + "\"";
+}
+
+static bool TranslateConstant(const ConstantFilter &filter, const NotionColumn &column,
+                              vector<std::string> &conditions) {
+    auto type_name = FilterTypeName(column.type);
+    const auto &constant = filter.constant;
+    if (!type_name || constant.IsNull()) {
+        return false;
+    }
+
+    switch (column.type) {
+    case NotionPropertyType::NUMBER: {
+        const char *operation;
+        switch (filter.comparison_type) {
+        case ExpressionType::COMPARE_EQUAL:
+            operation = "equals";
+            break;
+        case ExpressionType::COMPARE_NOTEQUAL:
+            operation = "does_not_equal";
+            break;
+        case ExpressionType::COMPARE_LESSTHAN:
+            operation = "less_than";
+            break;
+        case ExpressionType::COMPARE_GREATERTHAN:
+            operation = "greater_than";
+            break;
+        case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+            operation = "less_than_or_equal_to";
+            break;
+        case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+            operation = "greater_than_or_equal_to";
+            break;
+        default:
+            return false;
+        }
+        auto number = constant.GetValue<double>();
+        if (!std::isfinite(number)) {
+            return false;
+        }
+        conditions.push_back(MakeCondition(column, type_name, operation, Value::DOUBLE(number).ToString()));
+        return true;
+    }
+    case NotionPropertyType::CHECKBOX: {
+        bool checked = constant.GetValue<bool>();
+        if (filter.comparison_type == ExpressionType::COMPARE_NOTEQUAL) {
+            checked = !checked;
+        } else if (filter.comparison_type != ExpressionType::COMPARE_EQUAL) {
+            return false;
+        }
+        conditions.push_back(MakeCondition(column, type_name, "equals", checked ? "true" : "false"));
+        return true;
+    }
+    case NotionPropertyType::SELECT:
+    case NotionPropertyType::STATUS: {
+        const char *operation;
+        if (filter.comparison_type == ExpressionType::COMPARE_EQUAL) {
+            operation = "equals";
+        } else if (filter.comparison_type == ExpressionType::COMPARE_NOTEQUAL) {
+            operation = "does_not_equal";
+        } else {
+            return false;
+        }
+        std::string operand;
+        NotionUtils::AppendJsonString(operand, constant.ToString());
+        conditions.push_back(MakeCondition(column, type_name, operation, operand));
+        return true;
+    }
+    case NotionPropertyType::DATE:
+    case NotionPropertyType::CREATED_TIME:
+    case NotionPropertyType::LAST_EDITED_TIME: {
+        auto date = Timestamp::GetDate(constant.GetValue<timestamp_t>());
+        bool lower = false;
+        bool upper = false;
+        switch (filter.comparison_type) {
+        case ExpressionType::COMPARE_EQUAL:
+            lower = upper = true;
+            break;
+        case ExpressionType::COMPARE_GREATERTHAN:
+        case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+            lower = true;
+            break;
+        case ExpressionType::COMPARE_LESSTHAN:
+        case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+            upper = true;
+            break;
+        default:
+            return false;
+        }
+        if (lower) {
+            conditions.push_back(MakeCondition(column, type_name, "on_or_after", DateOperand(date, -DATE_FILTER_MARGIN_DAYS)));
+        }
+        if (upper) {
+            conditions.push_back(MakeCondition(column, type_name, "on_or_before", DateOperand(date, DATE_FILTER_MARGIN_DAYS)));
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+bool NotionFilter::Translate(const TableFilter &filter, const NotionColumn &column, vector<std::string> &conditions) {
+    switch (filter.filter_type) {
+    case TableFilterType::CONSTANT_COMPARISON:
+        return TranslateConstant(filter.Cast<ConstantFilter>(), column, conditions);
+    case TableFilterType::IS_NULL:
+    case TableFilterType::IS_NOT_NULL: {
+        auto type_name = FilterTypeName(column.type);
+        // Checkboxes and page timestamps are never empty. Lists are read as an empty list rather
+        // than NULL, so Notion's is_empty would not match what the column holds.
+        if (!type_name || column.type == NotionPropertyType::CHECKBOX ||
+            column.type == NotionPropertyType::CREATED_TIME || column.type == NotionPropertyType::LAST_EDITED_TIME ||
+            column.type == NotionPropertyType::MULTI_SELECT || column.type == NotionPropertyType::PEOPLE ||
+            column.type == NotionPropertyType::RELATION) {
+            return false;
+        }
+        bool is_null = filter.filter_type == TableFilterType::IS_NULL;
+        conditions.push_back(MakeCondition(column, type_name, is_null ? "is_empty" : "is_not_empty", "true"));
+        return true;
+    }
+    case TableFilterType::CONJUNCTION_AND: {
+        // Any subset of the conjuncts still selects a superset of the matching pages
+        bool translated = false;
+        for (const auto &child : filter.Cast<ConjunctionAndFilter>().child_filters) {
+            translated |= Translate(*child, column, conditions);
+        }
+        return translated;
+    }
+    case TableFilterType::CONJUNCTION_OR: {
+        // Every alternative must be translated, and Notion only allows two levels of nesting
+        vector<std::string> alternatives;
+        for (const auto &child : filter.Cast<ConjunctionOrFilter>().child_filters) {
+            vector<std::string> child_conditions;
+            if (!Translate(*child, column, child_conditions) || child_conditions.size() != 1 ||
+                child_conditions[0].compare(0, 5, "{\"or\"") == 0) {
+                return false;
+            }
+            alternatives.push_back(std::move(child_conditions[0]));
+        }
+        if (alternatives.empty()) {
+            return false;
+        }
+        std::string condition = "{\"or\":[";
+        for (idx_t i = 0; i < alternatives.size(); i++) {
+            if (i > 0) {
+                condition += ",";
+            }
+            condition += alternatives[i];
+        }
+        condition += "]}";
+        conditions.push_back(std::move(condition));
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+// Condition on one of the page timestamps, e.g. {"timestamp":"created_time","created_time":{"before":...}}
+static std::string TimestampCondition(const std::string &timestamp, const std::string &op, timestamp_t operand) {
+    return "{\"timestamp\":\"" + timestamp + "\",\"" + timestamp + "\":{\"" + op + "\":\"" +
+           NotionUtils::ToIsoTimestamp(operand) + "\"}}";
+}
+
+std::string NotionFilter::EditedSince(timestamp_t since) {
+    return TimestampCondition("last_edited_time", "on_or_after", since);
+}
+
+std::string NotionFilter::CreatedOnOrAfter(timestamp_t start) {
+    return TimestampCondition("created_time", "on_or_after", start);
+}
+
+std::string NotionFilter::CreatedBefore(timestamp_t end) {
+    return TimestampCondition("created_time", "before", end);
+}
+
+std::string NotionFilter::Combine(const vector<std::string> &conditions) {
+    if (conditions.empty()) {
+        return "";
+    }
+    if (conditions.size() == 1) {
+        return conditions[0];
+    }
+    std::string filter = "{\"and\":[";
+    for (idx_t i = 0; i < conditions.size(); i++) {
+        if (i > 0) {
+            filter += ",";
+        }
+        filter += conditions[i];
+    }
+    filter += "]}";
+    return filter;
+}
+
+unique_ptr<Expression> NotionFilter::ToExpression(const vector<NotionColumnFilter> &filters,
+                                                 const vector<LogicalType> &types) {
+    if (filters.empty()) {
+        return nullptr;
+    }
+    auto conjunction = make_uniq<BoundConjunctionExpression>(ExpressionType::CONJUNCTION_AND);
+    for (const auto &column_filter : filters) {
+        BoundReferenceExpression column(types[column_filter.output_idx], column_filter.output_idx);
+        conjunction->children.push_back(column_filter.filter->ToExpression(column));
+    }
+    if (conjunction->children.size() == 1) {
+        return std::move(conjunction->children[0]);
+    }
+    return std::move(conjunction);
+}
+
+bool NotionFilter::Matches(ClientContext &context, const TableFilter &filter, const Value &value) {
+    BoundConstantExpression constant(value);
+    auto result = ExpressionExecutor::EvaluateScalar(context, *filter.ToExpression(constant));
+    return !result.IsNull() && BooleanValue::Get(result);
+}
+
+void NotionFilter::Apply(ExpressionExecutor &executor, DataChunk &output) {
+    if (output.size() == 0) {
+        return;
+    }
+    SelectionVector sel(output.size());
+    auto result_count = executor.SelectExpression(output, sel);
+    if (result_count < output.size()) {
+        output.Slice(sel, result_count);
+    }
+}
+
+} // namespace duckdb
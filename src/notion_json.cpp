@@ -0,0 +1,418 @@
+#include "notion_json.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
+#include <cctype>
+#include <cstring>
+
+namespace duckdb {
+
+static int HexDigit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// Parses the four hex digits of a \u escape; returns -1 if they are malformed
+static int32_t ParseCodeUnit(const char *data, idx_t size, idx_t pos) {
+    if (pos + 4 > size) {
+        return -1;
+    }
+    int32_t code_unit = 0;
+    for (idx_t i = 0; i < 4; i++) {
+        int digit = HexDigit(data[pos + i]);
+        if (digit < 0) {
+            return -1;
+        }
+        code_unit = (code_unit << 4) | digit;
+    }
+    return code_unit;
+}
+
+static void AppendUTF8(std::string &out, uint32_t code_point) {
+    if (code_point < 0x80) {
+        out += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        out += static_cast<char>(0xC0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        out += static_cast<char>(0xE0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+bool NotionJsonString::Equals(const char *literal) const {
+    if (!has_escapes) {
+        return strlen(literal) == size && memcmp(data, literal, size) == 0;
+    }
+    return ToString() == literal;
+}
+
+bool NotionJsonString::Equals(const std::string &literal) const {
+    if (!has_escapes) {
+        return literal.size() == size && memcmp(data, literal.data(), size) == 0;
+    }
+    return ToString() == literal;
+}
+
+void NotionJsonString::AppendTo(std::string &out) const {
+    if (!has_escapes) {
+        out.append(data, size);
+        return;
+    }
+
+    idx_t run_start = 0;
+    for (idx_t i = 0; i < size; i++) {
+        if (data[i] != '\\') {
+            continue;
+        }
+        out.append(data + run_start, i - run_start);
+        if (++i >= size) {
+            break;
+        }
+        switch (data[i]) {
+        case 'b':
+            out += '\b';
+            break;
+        case 'f':
+            out += '\f';
+            break;
+        case 'n':
+            out += '\n';
+            break;
+        case 'r':
+            out += '\r';
+            break;
+        case 't':
+            out += '\t';
+            break;
+        case 'u': {
+            int32_t code_unit = ParseCodeUnit(data, size, i + 1);
+            if (code_unit < 0) {
+                out += "\xEF\xBF\xBD";
+                break;
+            }
+            i += 4;
+            uint32_t code_point = code_unit;
+            if (code_unit >= 0xD800 && code_unit <= 0xDBFF) {
+                // High surrogate: combine with the following \uDC00-\uDFFF escape
+                int32_t low = -1;
+                if (i + 2 < size && data[i + 1] == '\\' && data[i + 2] == 'u') {
+                    low = ParseCodeUnit(data, size, i + 3);
+                }
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    code_point = 0x10000 + ((code_unit - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                } else {
+                    code_point = 0xFFFD;
+                }
+            } else if (code_unit >= 0xDC00 && code_unit <= 0xDFFF) {
+                code_point = 0xFFFD;
+            }
+            AppendUTF8(out, code_point);
+            break;
+        }
+        default:
+            // \" \\ \/ and anything unknown map to the escaped character itself
+            out += data[i];
+            break;
+        }
+        run_start = i + 1;
+    }
+    out.append(data + run_start, size - run_start);
+}
+
+std::string NotionJsonString::ToString() const {
+    std::string result;
+    AppendTo(result);
+    return result;
+}
+
+NotionJsonCursor::NotionJsonCursor(const char *data, idx_t size) : data(data), size(size) {
+}
+
+NotionJsonCursor::NotionJsonCursor(const std::string &json) : data(json.data()), size(json.size()) {
+}
+
+void NotionJsonCursor::SkipWhitespace() {
+    while (pos < size && (data[pos] == ' ' || data[pos] == '\n' || data[pos] == '\r' || data[pos] == '\t')) {
+        pos++;
+    }
+}
+
+NotionJsonType NotionJsonCursor::Peek() {
+    SkipWhitespace();
+    if (error || pos >= size) {
+        return NotionJsonType::INVALID;
+    }
+    switch (data[pos]) {
+    case '{':
+        return NotionJsonType::OBJECT;
+    case '[':
+        return NotionJsonType::ARRAY;
+    case '"':
+        return NotionJsonType::STRING;
+    case 't':
+    case 'f':
+        return NotionJsonType::BOOLEAN;
+    case 'n':
+        return NotionJsonType::NULL_VALUE;
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        return NotionJsonType::NUMBER;
+    default:
+        return NotionJsonType::INVALID;
+    }
+}
+
+bool NotionJsonCursor::ScanString(NotionJsonString &result) {
+    // pos is on the opening quote
+    idx_t start = ++pos;
+    while (true) {
+        // memchr is vectorized by the C library, so long strings are skipped in bulk
+        auto quote = static_cast<const char *>(memchr(data + pos, '"', size - pos));
+        if (!quote) {
+            error = true;
+            pos = size;
+            return false;
+        }
+        idx_t quote_pos = quote - data;
+        // The quote is escaped if it is preceded by an odd number of backslashes
+        idx_t backslashes = 0;
+        while (quote_pos - backslashes > start && data[quote_pos - backslashes - 1] == '\\') {
+            backslashes++;
+        }
+        pos = quote_pos + 1;
+        if (backslashes % 2 == 0) {
+            result.data = data + start;
+            result.size = quote_pos - start;
+            result.has_escapes = memchr(result.data, '\\', result.size) != nullptr;
+            return true;
+        }
+    }
+}
+
+bool NotionJsonCursor::EnterObject() {
+    if (Peek() != NotionJsonType::OBJECT) {
+        SkipValue();
+        return false;
+    }
+    pos++;
+    first_member = true;
+    return true;
+}
+
+bool NotionJsonCursor::NextMember(char close) {
+    SkipWhitespace();
+    if (error) {
+        return false;
+    }
+    if (pos < size && data[pos] == close) {
+        pos++;
+        // The container is a value of its parent, so the parent's next member needs a comma
+        first_member = false;
+        return false;
+    }
+    if (!first_member) {
+        if (pos >= size || data[pos] != ',') {
+            error = true;
+            return false;
+        }
+        pos++;
+        SkipWhitespace();
+    }
+    first_member = false;
+    // A comma must be followed by a member: "[1,]" and "[,1]" are malformed
+    if (pos >= size || data[pos] == close || data[pos] == ',') {
+        error = true;
+        return false;
+    }
+    return true;
+}
+
+bool NotionJsonCursor::NextKey(NotionJsonString &key) {
+    if (!NextMember('}')) {
+        return false;
+    }
+    if (data[pos] != '"' || !ScanString(key)) {
+        error = true;
+        return false;
+    }
+    SkipWhitespace();
+    if (pos >= size || data[pos] != ':') {
+        error = true;
+        return false;
+    }
+    pos++;
+    return true;
+}
+
+bool NotionJsonCursor::EnterArray() {
+    if (Peek() != NotionJsonType::ARRAY) {
+        SkipValue();
+        return false;
+    }
+    pos++;
+    first_member = true;
+    return true;
+}
+
+bool NotionJsonCursor::NextElement() {
+    return NextMember(']');
+}
+
+bool NotionJsonCursor::ReadString(NotionJsonString &result) {
+    if (Peek() != NotionJsonType::STRING) {
+        SkipValue();
+        return false;
+    }
+    return ScanString(result);
+}
+
+bool NotionJsonCursor::ReadNumber(double &result) {
+    if (Peek() != NotionJsonType::NUMBER) {
+        SkipValue();
+        return false;
+    }
+    idx_t start = pos;
+    if (!ScanNumber()) {
+        return false;
+    }
+    // DuckDB's cast parses the exact span with fast_float, independent of the C locale
+    string_t number(data + start, static_cast<uint32_t>(pos - start));
+    if (!TryCast::Operation<string_t, double>(number, result, true)) {
+        error = true;
+        return false;
+    }
+    return true;
+}
+
+bool NotionJsonCursor::ScanNumber() {
+    auto digits = [&]() {
+        idx_t start = pos;
+        while (pos < size && isdigit(static_cast<unsigned char>(data[pos]))) {
+            pos++;
+        }
+        return pos > start;
+    };
+    if (pos < size && data[pos] == '-') {
+        pos++;
+    }
+    if (!digits()) {
+        error = true;
+        return false;
+    }
+    if (pos < size && data[pos] == '.') {
+        pos++;
+        if (!digits()) {
+            error = true;
+            return false;
+        }
+    }
+    if (pos < size && (data[pos] == 'e' || data[pos] == 'E')) {
+        pos++;
+        if (pos < size && (data[pos] == '+' || data[pos] == '-')) {
+            pos++;
+        }
+        if (!digits()) {
+            error = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NotionJsonCursor::ReadBoolean(bool &result) {
+    if (Peek() != NotionJsonType::BOOLEAN) {
+        SkipValue();
+        return false;
+    }
+    result = data[pos] == 't';
+    SkipValue();
+    return true;
+}
+
+void NotionJsonCursor::SkipValue() {
+    NotionJsonString string_value;
+    switch (Peek()) {
+    case NotionJsonType::STRING:
+        ScanString(string_value);
+        return;
+    case NotionJsonType::NUMBER:
+        ScanNumber();
+        return;
+    case NotionJsonType::BOOLEAN:
+    case NotionJsonType::NULL_VALUE:
+        while (pos < size && isalpha(static_cast<unsigned char>(data[pos]))) {
+            pos++;
+        }
+        return;
+    case NotionJsonType::OBJECT:
+    case NotionJsonType::ARRAY:
+        break;
+    default:
+        error = true;
+        return;
+    }
+
+    // Nested container: track depth, jumping over strings so brackets inside them are ignored
+    idx_t depth = 0;
+    while (pos < size) {
+        char c = data[pos];
+        if (c == '"') {
+            if (!ScanString(string_value)) {
+                return;
+            }
+            continue;
+        }
+        pos++;
+        if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+                return;
+            }
+        }
+    }
+    error = true;
+}
+
+void NotionJsonCursor::SkipValue(idx_t &start, idx_t &end) {
+    SkipWhitespace();
+    start = pos;
+    SkipValue();
+    end = pos;
+}
+
+bool NotionJsonCursor::FindKey(const char *key) {
+    NotionJsonString member;
+    while (NextKey(member)) {
+        if (member.Equals(key)) {
+            return true;
+        }
+        SkipValue();
+    }
+    return false;
+}
+
+} // namespace duckdb
@@ -0,0 +1,310 @@
+#include "notion_page_cache.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/main/extension_util.hpp"
+#include <ctime>
+#include <random>
+
+namespace duckdb {
+
+static const std::string MANIFEST_EXTENSION = ".manifest";
+static const std::string PAGE_EXTENSION = ".json";
+static const std::string ROW_COUNT_EXTENSION = ".rows";
+// Pages of chains that were never committed (e.g. by a process that stopped mid-scan) are removed
+// once they are this old; younger ones may belong to a scan that is still writing its chain
+static constexpr double ABANDONED_PAGE_SECONDS = 24 * 60 * 60;
+
+static bool EndsWith(const std::string &name, const std::string &suffix) {
+    return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static bool IsHex(const std::string &text) {
+    for (char c : text) {
+        if (!isxdigit(static_cast<unsigned char>(c))) {
+            return false;
+        }
+    }
+    return !text.empty();
+}
+
+// Matches the "<key>.<generation>.<page>.json" names of cached pages, so that clearing the
+// cache leaves other files in the directory alone
+static bool IsPageFile(const std::string &name) {
+    if (!EndsWith(name, PAGE_EXTENSION)) {
+        return false;
+    }
+    auto stem = name.substr(0, name.size() - PAGE_EXTENSION.size());
+    auto page_start = stem.rfind('.');
+    if (page_start == std::string::npos || page_start < 17 || stem[page_start - 17] != '.') {
+        return false;
+    }
+    auto page = stem.substr(page_start + 1);
+    return !page.empty() && page.find_first_not_of("0123456789") == std::string::npos &&
+           IsHex(stem.substr(page_start - 16, 16));
+}
+
+static std::string ToHex(uint64_t value) {
+    static const char *HEX_DIGITS = "0123456789abcdef";
+    std::string result(16, '0');
+    for (idx_t i = 16; i > 0; i--) {
+        result[i - 1] = HEX_DIGITS[value & 0xF];
+        value >>= 4;
+    }
+    return result;
+}
+
+static std::string ReadFile(FileSystem &fs, const std::string &path) {
+    auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ);
+    std::string contents(handle->GetFileSize(), '\0');
+    handle->Read(&contents[0], contents.size(), 0);
+    return contents;
+}
+
+static void WriteFile(FileSystem &fs, const std::string &path, const std::string &contents) {
+    auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_WRITE | FileFlags::FILE_FLAGS_FILE_CREATE_NEW);
+    handle->Write(const_cast<char *>(contents.data()), contents.size(), 0);
+    handle->Close();
+}
+
+NotionPageCache::NotionPageCache(FileSystem &fs_p, std::string directory_p, idx_t ttl_seconds_p)
+    : fs(fs_p), directory(std::move(directory_p)), ttl_seconds(ttl_seconds_p) {
+}
+
+shared_ptr<NotionPageCache> NotionPageCache::Create(ClientContext &context) {
+    Value setting;
+    if (!context.TryGetCurrentSetting("notion_cache_directory", setting) || setting.IsNull()) {
+        return nullptr;
+    }
+    auto directory = setting.ToString();
+    if (directory.empty()) {
+        return nullptr;
+    }
+
+    idx_t ttl_seconds = DEFAULT_TTL_SECONDS;
+    if (context.TryGetCurrentSetting("notion_cache_ttl", setting) && !setting.IsNull()) {
+        ttl_seconds = setting.GetValue<uint64_t>();
+    }
+
+    auto &fs = FileSystem::GetFileSystem(context);
+    if (!fs.DirectoryExists(directory)) {
+        fs.CreateDirectory(directory);
+    }
+    return make_shared_ptr<NotionPageCache>(fs, directory, ttl_seconds);
+}
+
+std::string NotionPageCache::GetKey(const std::string &database_id, const std::string &auth_token,
+                                    const NotionQueryOptions &options) {
+    // Integrations see different pages of the same database, so the token is part of the key.
+    // Only its hash ends up in the file name.
+    std::string query = auth_token + "\n" + options.filter + "\n" + options.sorts + "\n" +
+                        std::to_string(options.page_size);
+    for (const auto &property : options.filter_properties) {
+        query += "\n" + property;
+    }
+    // Keep the database id readable so entries can be told apart on disk
+    return database_id + "-" + ToHex(Hash(query.data(), query.size()));
+}
+
+std::string NotionPageCache::ManifestPath(const std::string &key) {
+    return fs.JoinPath(directory, key + MANIFEST_EXTENSION);
+}
+
+std::string NotionPageCache::RowCountPath(const std::string &database_id) {
+    return fs.JoinPath(directory, database_id + ROW_COUNT_EXTENSION);
+}
+
+std::string NotionPageCache::PagePath(const std::string &key, const NotionCacheEntry &entry, idx_t page_index) {
+    return fs.JoinPath(directory, key + "." + entry.generation + "." + std::to_string(page_index) + PAGE_EXTENSION);
+}
+
+bool NotionPageCache::ReadManifest(const std::string &key, NotionCacheEntry &entry, bool check_ttl) {
+    auto path = ManifestPath(key);
+    auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ | FileFlags::FILE_FLAGS_NULL_IF_NOT_EXISTS);
+    if (!handle) {
+        return false;
+    }
+    if (check_ttl && std::difftime(std::time(nullptr), fs.GetLastModifiedTime(*handle)) >= ttl_seconds) {
+        return false;
+    }
+
+    // "<generation> <page count>"; anything else, e.g. a truncated manifest, is a cache miss
+    std::string contents(handle->GetFileSize(), '\0');
+    handle->Read(&contents[0], contents.size(), 0);
+    auto separator = contents.find(' ');
+    if (separator == std::string::npos || !IsHex(contents.substr(0, separator))) {
+        return false;
+    }
+    auto count = contents.substr(separator + 1);
+    if (count.empty() || count.size() > 18 || count.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    entry.generation = contents.substr(0, separator);
+    entry.page_count = strtoull(count.c_str(), nullptr, 10);
+    return entry.page_count > 0;
+}
+
+bool NotionPageCache::Lookup(const std::string &key, NotionCacheEntry &entry) {
+    return ReadManifest(key, entry, true);
+}
+
+std::string NotionPageCache::ReadPage(const std::string &key, const NotionCacheEntry &entry, idx_t page_index) {
+    return ReadFile(fs, PagePath(key, entry, page_index));
+}
+
+NotionCacheEntry NotionPageCache::Begin() {
+    thread_local std::mt19937_64 generator(std::random_device {}());
+    NotionCacheEntry entry;
+    entry.generation = ToHex(generator());
+    return entry;
+}
+
+void NotionPageCache::WritePage(const std::string &key, const NotionCacheEntry &entry, idx_t page_index,
+                                const std::string &body) {
+    WriteFile(fs, PagePath(key, entry, page_index), body);
+}
+
+void NotionPageCache::RemovePages(const std::string &key, const NotionCacheEntry &entry) {
+    for (idx_t page_index = 0; page_index < entry.page_count; page_index++) {
+        fs.RemoveFile(PagePath(key, entry, page_index));
+    }
+}
+
+void NotionPageCache::Abandon(const std::string &key, const NotionCacheEntry &entry, idx_t pages_written) {
+    for (idx_t page_index = 0; page_index < pages_written; page_index++) {
+        try {
+            fs.RemoveFile(PagePath(key, entry, page_index));
+        } catch (std::exception &ex) {
+            // Left for RemoveAbandonedPages
+        }
+    }
+}
+
+void NotionPageCache::RemoveAbandonedPages(const std::string &key, const NotionCacheEntry &current) {
+    auto prefix = key + ".";
+    vector<std::string> abandoned;
+    fs.ListFiles(directory, [&](const std::string &name, bool is_directory) {
+        if (!is_directory && name.compare(0, prefix.size(), prefix) == 0 && IsPageFile(name) &&
+            name.compare(prefix.size(), current.generation.size(), current.generation) != 0) {
+            abandoned.push_back(fs.JoinPath(directory, name));
+        }
+    });
+    for (const auto &path : abandoned) {
+        try {
+            auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ | FileFlags::FILE_FLAGS_NULL_IF_NOT_EXISTS);
+            if (!handle || std::difftime(std::time(nullptr), fs.GetLastModifiedTime(*handle)) < ABANDONED_PAGE_SECONDS) {
+                continue;
+            }
+            handle.reset();
+            fs.RemoveFile(path);
+        } catch (std::exception &ex) {
+            // Removed concurrently
+        }
+    }
+}
+
+void NotionPageCache::Commit(const std::string &key, const NotionCacheEntry &entry) {
+    NotionCacheEntry previous;
+    bool has_previous = ReadManifest(key, previous, false);
+
+    // Publish the new chain by replacing the manifest in one rename
+    auto temp_path = ManifestPath(key) + "." + entry.generation;
+    WriteFile(fs, temp_path, entry.generation + " " + std::to_string(entry.page_count));
+    fs.MoveFile(temp_path, ManifestPath(key));
+
+    // The chain is published; failing to clean up after it must not undo that
+    try {
+        if (has_previous && previous.generation != entry.generation) {
+            RemovePages(key, previous);
+        }
+        RemoveAbandonedPages(key, entry);
+    } catch (std::exception &ex) {
+        // Old pages are removed by a later commit or by notion_cache_clear()
+    }
+}
+
+bool NotionPageCache::ReadRowCount(const std::string &database_id, idx_t &row_count) {
+    auto handle =
+        fs.OpenFile(RowCountPath(database_id), FileFlags::FILE_FLAGS_READ | FileFlags::FILE_FLAGS_NULL_IF_NOT_EXISTS);
+    if (!handle) {
+        return false;
+    }
+    std::string contents(handle->GetFileSize(), '\0');
+    handle->Read(&contents[0], contents.size(), 0);
+    if (contents.empty() || contents.size() > 18 || contents.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    row_count = strtoull(contents.c_str(), nullptr, 10);
+    return true;
+}
+
+void NotionPageCache::WriteRowCount(const std::string &database_id, idx_t row_count) {
+    // Replaced in one rename like a manifest, so readers never see a partial count
+    auto path = RowCountPath(database_id);
+    auto temp_path = path + "." + Begin().generation;
+    WriteFile(fs, temp_path, std::to_string(row_count));
+    fs.MoveFile(temp_path, path);
+}
+
+idx_t NotionPageCache::Clear() {
+    vector<std::string> files;
+    idx_t removed = 0;
+    fs.ListFiles(directory, [&](const std::string &name, bool is_directory) {
+        if (is_directory) {
+            return;
+        }
+        if (EndsWith(name, MANIFEST_EXTENSION)) {
+            removed++;
+        } else if (!IsPageFile(name) && !EndsWith(name, ROW_COUNT_EXTENSION) &&
+                   name.find(MANIFEST_EXTENSION + ".") == std::string::npos &&
+                   name.find(ROW_COUNT_EXTENSION + ".") == std::string::npos) {
+            // Not written by the cache
+            return;
+        }
+        files.push_back(name);
+    });
+    for (const auto &name : files) {
+        fs.RemoveFile(fs.JoinPath(directory, name));
+    }
+    return removed;
+}
+
+struct NotionCacheClearState : public GlobalTableFunctionState {
+    bool done = false;
+};
+
+static unique_ptr<FunctionData> NotionCacheClearBind(ClientContext &context, TableFunctionBindInput &input,
+                                                     vector<LogicalType> &return_types, vector<string> &names) {
+    names.push_back("entries_removed");
+    return_types.push_back(LogicalType::BIGINT);
+    return make_uniq<TableFunctionData>();
+}
+
+static unique_ptr<GlobalTableFunctionState> NotionCacheClearInit(ClientContext &context,
+                                                                 TableFunctionInitInput &input) {
+    return make_uniq<NotionCacheClearState>();
+}
+
+static void NotionCacheClearFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &state = data_p.global_state->Cast<NotionCacheClearState>();
+    if (state.done) {
+        return;
+    }
+    state.done = true;
+
+    idx_t removed = 0;
+    auto cache = NotionPageCache::Create(context);
+    if (cache) {
+        removed = cache->Clear();
+    }
+    output.SetValue(0, 0, Value::BIGINT(removed));
+    output.SetCardinality(1);
+}
+
+void NotionPageCache::RegisterFunctions(DatabaseInstance &db) {
+    TableFunction cache_clear("notion_cache_clear", {}, NotionCacheClearFunction, NotionCacheClearBind,
+                              NotionCacheClearInit);
+    ExtensionUtil::RegisterFunction(db, cache_clear);
+}
+
+} // namespace duckdb
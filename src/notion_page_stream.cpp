@@ -0,0 +1,216 @@
+#include "notion_page_stream.hpp"
+#include "notion_json.hpp"
+#include "notion_stats.hpp"
+#include "duckdb/common/exception.hpp"
+
+namespace duckdb {
+
+shared_ptr<NotionPendingQuery> NotionPendingQuery::Start(const std::string &database_id,
+                                                         const std::string &auth_token,
+                                                         const NotionQueryOptions &options) {
+    auto pending = make_shared_ptr<NotionPendingQuery>();
+    // An abandoned request is cancelled with the future, and is not sent if it is still waiting
+    pending->response = NotionRequests::QueryDatabaseAsync(database_id, auth_token, "", "", options);
+    return pending;
+}
+
+NotionRequestFuture NotionPendingQuery::Take() {
+    // Only the scan that claimed the query waits for it, so the request can be handed over
+    return std::move(response);
+}
+
+NotionPageStream::NotionPageStream(std::string database_id_p, std::string auth_token_p,
+                                   NotionQueryOptions options_p, idx_t prefetch_depth_p,
+                                   shared_ptr<NotionPendingQuery> first_page_p,
+                                   shared_ptr<NotionPageCache> cache_p)
+    : database_id(std::move(database_id_p)), auth_token(std::move(auth_token_p)), options(std::move(options_p)),
+      prefetch_depth(prefetch_depth_p), first_page(std::move(first_page_p)), cache(std::move(cache_p)) {
+    if (cache) {
+        cache_key = NotionPageCache::GetKey(database_id, auth_token, options);
+        cached = cache->Lookup(cache_key, cache_entry);
+        if (cached) {
+            first_page.reset();
+        } else {
+            cache_entry = cache->Begin();
+        }
+    }
+    if (prefetch_depth > 0) {
+        worker = std::thread(&NotionPageStream::Prefetch, this);
+    }
+}
+
+NotionPageStream::~NotionPageStream() {
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopped = true;
+        }
+        page_cv.notify_all();
+        worker.join();
+    }
+    if (cache && !cached && !committed && page_index > 0) {
+        // The scan stopped before the end of the chain (e.g. a LIMIT), so it is not cached
+        cache->Abandon(cache_key, cache_entry, page_index);
+    }
+}
+
+NotionResultPage NotionPageStream::ParseResponse(std::string body) {
+    auto parse_start = std::chrono::steady_clock::now();
+    NotionResultPage page;
+    page.body = std::move(body);
+
+    NotionJsonCursor cursor(page.body);
+    if (cursor.EnterObject()) {
+        NotionJsonString key;
+        while (cursor.NextKey(key)) {
+            if (key.Equals("results")) {
+                if (!cursor.EnterArray()) {
+                    continue;
+                }
+                while (cursor.NextElement()) {
+                    idx_t start, end;
+                    cursor.SkipValue(start, end);
+                    page.results.push_back({start, end - start});
+                }
+            } else if (key.Equals("has_more")) {
+                bool has_more;
+                if (cursor.ReadBoolean(has_more)) {
+                    page.has_more = has_more;
+                }
+            } else if (key.Equals("next_cursor")) {
+                NotionJsonString next_cursor;
+                if (cursor.ReadString(next_cursor)) {
+                    page.next_cursor = next_cursor.ToString();
+                }
+            } else {
+                cursor.SkipValue();
+            }
+        }
+    }
+
+    if (cursor.HasError()) {
+        throw IOException("Failed to parse Notion API response");
+    }
+    NotionStats::Get().Record(NotionStatPhase::PARSE, NotionStats::ElapsedMicros(parse_start));
+    return page;
+}
+
+void NotionPageStream::StorePage(const std::string &body, bool last_page) {
+    try {
+        cache->WritePage(cache_key, cache_entry, page_index, body);
+        page_index++;
+        if (last_page) {
+            cache_entry.page_count = page_index;
+            cache->Commit(cache_key, cache_entry);
+            committed = true;
+        }
+    } catch (std::exception &ex) {
+        // The cache is best effort: stop writing to it, but keep reading from Notion
+        if (!committed) {
+            cache->Abandon(cache_key, cache_entry, page_index);
+        }
+        cache.reset();
+    }
+}
+
+bool NotionPageStream::Stopped() {
+    std::lock_guard<std::mutex> guard(lock);
+    return stopped;
+}
+
+bool NotionPageStream::Fetch(const std::string &start_cursor, NotionResultPage &page) {
+    if (cached) {
+        page = ParseResponse(cache->ReadPage(cache_key, cache_entry, page_index));
+        page_index++;
+        // The chain ends with the last cached page
+        page.has_more = page.has_more && page_index < cache_entry.page_count;
+        return true;
+    }
+
+    NotionRequestFuture request;
+    if (first_page && start_cursor.empty()) {
+        // The first page was requested ahead of time
+        request = first_page->Take();
+        first_page.reset();
+    } else {
+        request = NotionRequests::QueryDatabaseAsync(database_id, auth_token, start_cursor, "", options);
+    }
+    // The request may be waiting for a rate limit token or a retry; a stream destroyed in the
+    // meantime (e.g. under a LIMIT) drops it, which cancels it, instead of waiting for it
+    static constexpr auto STOP_CHECK_INTERVAL = std::chrono::milliseconds(20);
+    while (!request.WaitFor(STOP_CHECK_INTERVAL)) {
+        if (Stopped()) {
+            return false;
+        }
+    }
+    auto response = request.Get();
+
+    if (!response.success) {
+        throw InvalidInputException("Failed to query Notion database: " + response.body);
+    }
+    page = ParseResponse(std::move(response.body));
+    if (cache) {
+        StorePage(page.body, !page.has_more || page.next_cursor.empty());
+    }
+    return true;
+}
+
+void NotionPageStream::Prefetch() {
+    try {
+        while (has_more) {
+            // Wait for room in the buffer, which bounds memory to prefetch_depth pages
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                page_cv.wait(guard, [&]() { return stopped || pages.size() < prefetch_depth; });
+                if (stopped) {
+                    return;
+                }
+            }
+
+            NotionResultPage page;
+            if (!Fetch(next_cursor, page)) {
+                return;
+            }
+            has_more = page.has_more && !page.next_cursor.empty();
+            next_cursor = page.next_cursor;
+
+            std::lock_guard<std::mutex> guard(lock);
+            pages.push_back(std::move(page));
+            page_cv.notify_all();
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> guard(lock);
+        error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    finished = true;
+    page_cv.notify_all();
+}
+
+bool NotionPageStream::Next(NotionResultPage &page) {
+    if (prefetch_depth == 0) {
+        if (!has_more) {
+            return false;
+        }
+        Fetch(next_cursor, page);
+        has_more = page.has_more && !page.next_cursor.empty();
+        next_cursor = page.next_cursor;
+        return true;
+    }
+
+    std::unique_lock<std::mutex> guard(lock);
+    page_cv.wait(guard, [&]() { return !pages.empty() || finished; });
+    if (!pages.empty()) {
+        page = std::move(pages.front());
+        pages.pop_front();
+        page_cv.notify_all();
+        return true;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return false;
+}
+
+} // namespace duckdb
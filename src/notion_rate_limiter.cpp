@@ -0,0 +1,90 @@
+#include "notion_rate_limiter.hpp"
+#include "notion_utils.hpp"
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+namespace duckdb {
+
+NotionRateLimiter::NotionRateLimiter(double requests_per_second_p, double burst_p)
+    : requests_per_second(requests_per_second_p), burst(std::max(burst_p, 1.0)), tokens(burst),
+      last_refill(std::chrono::steady_clock::now()), paused_until(last_refill) {
+}
+
+// Limiters by auth token; like the connection pool they live for the lifetime of the process
+struct NotionRateLimiterRegistry {
+    std::mutex lock;
+    double requests_per_second = NotionRateLimiter::DEFAULT_REQUESTS_PER_SECOND;
+    std::unordered_map<std::string, unique_ptr<NotionRateLimiter>> limiters;
+};
+
+static NotionRateLimiterRegistry &GetRegistry() {
+    static auto registry = new NotionRateLimiterRegistry();
+    return *registry;
+}
+
+NotionRateLimiter &NotionRateLimiter::ForToken(const std::string &auth_token) {
+    auto &registry = GetRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    auto &limiter = registry.limiters[auth_token];
+    if (!limiter) {
+        limiter = make_uniq<NotionRateLimiter>(registry.requests_per_second);
+    }
+    return *limiter;
+}
+
+void NotionRateLimiter::SetDefaultRate(ClientContext &context, SetScope scope, Value &parameter) {
+    NotionUtils::CheckGlobalScope(scope, "notion_requests_per_second");
+    auto &registry = GetRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    registry.requests_per_second = parameter.GetValue<double>();
+    for (auto &entry : registry.limiters) {
+        entry.second->SetRate(registry.requests_per_second);
+    }
+}
+
+void NotionRateLimiter::Refill(std::chrono::steady_clock::time_point now) {
+    std::chrono::duration<double> elapsed = now - last_refill;
+    last_refill = now;
+    tokens = std::min(burst, tokens + elapsed.count() * requests_per_second);
+}
+
+std::chrono::steady_clock::time_point NotionRateLimiter::Reserve() {
+    std::lock_guard<std::mutex> guard(lock);
+    auto now = std::chrono::steady_clock::now();
+    auto send_at = std::max(now, paused_until);
+    if (requests_per_second > 0) {
+        Refill(now);
+        tokens -= 1;
+        if (tokens < 0) {
+            send_at += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(-tokens / requests_per_second));
+        }
+    }
+    // A rate of zero disables limiting, but a pause requested by the server still applies
+    return send_at;
+}
+
+void NotionRateLimiter::Acquire() {
+    std::this_thread::sleep_until(Reserve());
+}
+
+void NotionRateLimiter::Release() {
+    std::lock_guard<std::mutex> guard(lock);
+    tokens = std::min(burst, tokens + 1);
+}
+
+void NotionRateLimiter::Pause(double seconds) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto until = std::chrono::steady_clock::now() +
+                 std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    paused_until = std::max(paused_until, until);
+}
+
+void NotionRateLimiter::SetRate(double requests_per_second_p) {
+    std::lock_guard<std::mutex> guard(lock);
+    Refill(std::chrono::steady_clock::now());
+    requests_per_second = requests_per_second_p;
+}
+
+} // namespace duckdb
@@ -2,258 +2,887 @@
 #include "notion_auth.hpp"
 #include "notion_requests.hpp"
 #include "notion_utils.hpp"
+#include "notion_json.hpp"
+#include "notion_schema.hpp"
+#include "notion_decoder.hpp"
+#include "notion_filter.hpp"
+#include "notion_page_stream.hpp"
+#include "notion_page_cache.hpp"
+#include "notion_relations.hpp"
+#include "notion_schema_cache.hpp"
+#include "notion_stats.hpp"
 #include "duckdb/main/extension_util.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/interval.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
+#include "duckdb/storage/object_cache.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 
 namespace duckdb {
 
-struct NotionReadBindData : public TableFunctionData {
+// One database read by a scan
+struct NotionReadSource {
     std::string database_id;
+    // The columns of this database
+    vector<NotionColumn> columns;
+    // Per output column, the index of this database's column (INVALID_INDEX when it has none)
+    vector<idx_t> column_map;
+    // Unfiltered first page, requested concurrently with the schema
+    shared_ptr<NotionPendingQuery> first_page;
+};
+
+struct NotionReadBindData : public TableFunctionData {
     std::string auth_token;
-    vector<string> column_names;
-    vector<LogicalType> column_types;
+    vector<NotionReadSource> sources;
+    // Output columns: the columns of the database, or of all databases when several are read
+    vector<NotionColumn> columns;
+    // A database_id column naming the database of each row follows the columns
+    bool source_column = false;
+    // Only pages edited at or after this time are read (edited_since parameter)
+    bool has_edited_since = false;
+    timestamp_t edited_since;
+    // Relation columns list the ids and titles of the related pages (expand_relations parameter)
+    bool expand_relations = false;
+};
+
+// Row counts seen by earlier scans of a DatabaseInstance, by database id. Notion does not report
+// the size of a database, so these are the only basis for cardinality estimates and scan
+// progress. With notion_cache_directory set, they are also kept on disk to survive a restart.
+class NotionRowCounts : public ObjectCacheEntry {
+public:
+    static shared_ptr<NotionRowCounts> Get(ClientContext &context) {
+        return ObjectCache::GetObjectCache(context).GetOrCreate<NotionRowCounts>(ObjectType());
+    }
+
+    bool Lookup(const std::string &database_id, NotionPageCache *cache, idx_t &row_count) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto entry = row_counts.find(database_id);
+            if (entry != row_counts.end()) {
+                row_count = entry->second;
+                return true;
+            }
+        }
+        try {
+            if (!cache || !cache->ReadRowCount(database_id, row_count)) {
+                return false;
+            }
+        } catch (std::exception &ex) {
+            // Only an estimate: an unreadable count is an unknown one
+            return false;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        row_counts.emplace(database_id, row_count);
+        return true;
+    }
+
+    // A complete scan replaces the estimate; a scan that stopped early (e.g. under a LIMIT) only
+    // shows that the database has at least rows_read rows
+    void Update(const std::string &database_id, NotionPageCache *cache, idx_t rows_read, bool complete) {
+        idx_t row_count;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto &entry = row_counts[database_id];
+            entry = complete ? rows_read : MaxValue(entry, rows_read);
+            row_count = entry;
+        }
+        if (!cache || !complete) {
+            return;
+        }
+        try {
+            cache->WriteRowCount(database_id, row_count);
+        } catch (std::exception &ex) {
+            // Best effort, like the page cache
+        }
+    }
+
+    static std::string ObjectType() {
+        return "notion_row_counts";
+    }
+    std::string GetObjectType() override {
+        return ObjectType();
+    }
+
+private:
+    std::mutex lock;
+    std::unordered_map<std::string, idx_t> row_counts;
+};
+
+static bool GetRowCountEstimate(ClientContext &context, const std::string &database_id, idx_t &row_count) {
+    auto cache = NotionPageCache::Create(context);
+    return NotionRowCounts::Get(context)->Lookup(database_id, cache.get(), row_count);
+}
+
+// Results per query page (Notion's default and maximum)
+static constexpr idx_t NOTION_PAGE_SIZE = 100;
+
+// Scan state of one database
+struct NotionReadSourceState {
+    std::string database_id;
+    // Query options before partitioning
+    NotionQueryOptions query_options;
+    // Per output vector, the column of the database decoded into it
+    vector<idx_t> column_ids;
+    // True when every column of the database has its output type, so pages are decoded straight
+    // into the output chunk; otherwise they are decoded with the database's types and cast
+    bool direct = true;
+    vector<LogicalType> decode_types;
+    std::atomic<idx_t> rows_read {0};
+    std::atomic<idx_t> partitions_left {0};
+};
+
+// A cursor chain read by one thread: a database, or a created_time range of one
+struct NotionReadPartition {
+    idx_t source_idx;
+    NotionQueryOptions options;
+    // First page requested at bind, used by an unpartitioned database
+    shared_ptr<NotionPendingQuery> first_page;
 };
 
 struct NotionReadGlobalState : public GlobalTableFunctionState {
-    std::string next_cursor;
-    bool has_more = true;
-    vector<string> results_buffer;
-    idx_t current_row = 0;
+    ~NotionReadGlobalState() override {
+        // Only scans that Notion did not filter saw every row of a database
+        for (auto &source : sources) {
+            if (source->query_options.filter.empty() && source->rows_read > 0) {
+                row_counts->Update(source->database_id, row_count_cache.get(), source->rows_read,
+                                   source->partitions_left == 0);
+            }
+        }
+    }
+
+    std::string auth_token;
+    vector<unique_ptr<NotionReadSourceState>> sources;
+    // Pushed-down filters, re-evaluated locally on every chunk
+    vector<NotionColumnFilter> filters;
+    unique_ptr<Expression> filter_expression;
+    // Output vector of the database_id column, INVALID_INDEX when it is not projected
+    idx_t source_column_idx = DConstants::INVALID_INDEX;
+    // Threads claim partitions in order until none are left
+    vector<NotionReadPartition> partitions;
+    std::atomic<idx_t> next_partition {0};
+    // Rows decoded so far, before local filtering; read by the progress callback
+    std::atomic<idx_t> rows_read {0};
+    // Row count of the last scans of the databases, 0 when unknown
+    idx_t estimated_rows = 0;
+    // Where the row counts of this scan are recorded once it ends
+    shared_ptr<NotionRowCounts> row_counts;
+    shared_ptr<NotionPageCache> row_count_cache;
+    // Output vectors of expanded relation columns, and the titles of the pages they reference
+    vector<idx_t> relation_columns;
+    unique_ptr<NotionRelationResolver> relations;
 
     idx_t MaxThreads() const override {
-        return 1;
+        return MaxValue<idx_t>(partitions.size(), 1);
     }
 };
 
-// Helper function to extract property value from JSON
-static Value ExtractPropertyValue(const std::string &json, const std::string &property_name, const std::string &property_type) {
-    // Find the property in the JSON
-    std::string search_str = "\"" + property_name + "\"";
-    size_t prop_pos = json.find(search_str);
-    if (prop_pos == std::string::npos) {
-        return Value();
-    }
-
-    // Simple JSON parsing based on property type
-    if (property_type == "title" || property_type == "rich_text") {
-        // Look for the text content
-        size_t text_pos = json.find("\"plain_text\"", prop_pos);
-        if (text_pos != std::string::npos) {
-            size_t start = json.find("\"", text_pos + 13);
-            if (start != std::string::npos) {
-                start++;
-                size_t end = json.find("\"", start);
-                if (end != std::string::npos) {
-                    return Value(json.substr(start, end - start));
+// The partition a thread is reading
+struct NotionReadLocalState : public LocalTableFunctionState {
+    idx_t source_idx = DConstants::INVALID_INDEX;
+    unique_ptr<NotionPageDecoder> decoder;
+    // Chunk pages are decoded into when the database's column types differ from the output
+    unique_ptr<DataChunk> decode_chunk;
+    unique_ptr<NotionPageStream> stream;
+    NotionResultPage page;
+    idx_t current_row = 0;
+    bool finished = false;
+    // Evaluates the pushed-down filters; executors are not shared between threads
+    unique_ptr<ExpressionExecutor> filter_executor;
+};
+
+// Reads the prefetch depth setting
+static idx_t GetPrefetchDepth(ClientContext &context) {
+    Value depth;
+    if (context.TryGetCurrentSetting("notion_prefetch_depth", depth) && !depth.IsNull()) {
+        return depth.GetValue<uint64_t>();
+    }
+    return NotionPageStream::DEFAULT_PREFETCH_DEPTH;
+}
+
+static idx_t GetRelationConcurrency(ClientContext &context) {
+    Value concurrency;
+    if (context.TryGetCurrentSetting("notion_relation_concurrency", concurrency) && !concurrency.IsNull()) {
+        return MaxValue<idx_t>(concurrency.GetValue<uint64_t>(), 1);
+    }
+    return NotionRelationResolver::DEFAULT_CONCURRENCY;
+}
+
+static idx_t GetScanPartitions(ClientContext &context) {
+    Value partitions;
+    if (context.TryGetCurrentSetting("notion_scan_partitions", partitions) && !partitions.IsNull()) {
+        return MaxValue<idx_t>(partitions.GetValue<uint64_t>(), 1);
+    }
+    return NotionRead::DEFAULT_SCAN_PARTITIONS;
+}
+
+// Reads the database ids or URLs of the first argument, a single one or a list
+static vector<std::string> GetDatabaseIds(const Value &input) {
+    vector<std::string> database_ids;
+    if (input.IsNull()) {
+        throw BinderException("read_notion requires a database id");
+    }
+    if (input.type().id() != LogicalTypeId::LIST) {
+        database_ids.push_back(NotionUtils::ExtractDatabaseId(input.ToString()));
+        return database_ids;
+    }
+    for (const auto &child : ListValue::GetChildren(input)) {
+        if (child.IsNull()) {
+            throw BinderException("read_notion database ids cannot be NULL");
+        }
+        database_ids.push_back(NotionUtils::ExtractDatabaseId(child.ToString()));
+    }
+    if (database_ids.empty()) {
+        throw BinderException("read_notion requires at least one database id");
+    }
+    return database_ids;
+}
+
+static idx_t FindColumn(const vector<NotionColumn> &columns, const std::string &name) {
+    for (idx_t i = 0; i < columns.size(); i++) {
+        if (StringUtil::CIEquals(columns[i].name, name)) {
+            return i;
+        }
+    }
+    return DConstants::INVALID_INDEX;
+}
+
+// Combines the types of a select, status or multi-select column read from several databases: the
+// ENUMs of their options are merged, and an ENUM meets text as text. Returns false for other types.
+static bool MergeOptionTypes(const LogicalType &left, const LogicalType &right, LogicalType &result) {
+    if (left.id() == LogicalTypeId::LIST && right.id() == LogicalTypeId::LIST) {
+        LogicalType child;
+        if (!MergeOptionTypes(ListType::GetChildType(left), ListType::GetChildType(right), child)) {
+            return false;
+        }
+        result = LogicalType::LIST(child);
+        return true;
+    }
+    if (left.id() != LogicalTypeId::ENUM && right.id() != LogicalTypeId::ENUM) {
+        return false;
+    }
+    if (left.id() == LogicalTypeId::VARCHAR || right.id() == LogicalTypeId::VARCHAR) {
+        result = LogicalType::VARCHAR;
+        return true;
+    }
+    if (left.id() != right.id()) {
+        return false;
+    }
+    vector<std::string> options;
+    for (const auto &type : {left, right}) {
+        auto labels = FlatVector::GetData<string_t>(EnumType::GetValuesInsertOrder(type));
+        for (idx_t i = 0; i < EnumType::GetSize(type); i++) {
+            options.push_back(labels[i].GetString());
+        }
+    }
+    result = NotionSchema::GetEnumType(options);
+    return true;
+}
+
+// Builds the output columns of several databases and maps each database's columns onto them.
+// Columns are matched by name. With union_by_name, a column missing from a database is NULL for
+// its rows and a column whose types differ becomes VARCHAR; without it, the databases must have
+// the same columns.
+static void UnifyColumns(NotionReadBindData &bind_data, bool union_by_name) {
+    auto &columns = bind_data.columns;
+    columns = bind_data.sources[0].columns;
+    for (idx_t source_idx = 1; source_idx < bind_data.sources.size(); source_idx++) {
+        const auto &source = bind_data.sources[source_idx];
+        for (const auto &column : source.columns) {
+            auto column_idx = FindColumn(columns, column.name);
+            if (column_idx == DConstants::INVALID_INDEX) {
+                if (!union_by_name) {
+                    throw BinderException("read_notion: column \"%s\" of database %s is not a column of database %s "
+                                          "(set union_by_name = true to combine different columns)",
+                                          column.name, source.database_id, bind_data.sources[0].database_id);
                 }
+                columns.push_back(column);
+                continue;
             }
-        }
-    } else if (property_type == "number") {
-        size_t num_pos = json.find("\"number\"", prop_pos);
-        if (num_pos != std::string::npos) {
-            size_t colon = json.find(":", num_pos);
-            if (colon != std::string::npos) {
-                size_t start = colon + 1;
-                while (start < json.length() && isspace(json[start])) start++;
-                if (start < json.length() && (isdigit(json[start]) || json[start] == '-')) {
-                    size_t end = start;
-                    while (end < json.length() && (isdigit(json[end]) || json[end] == '.' || json[end] == '-')) end++;
-                    std::string num_str = json.substr(start, end - start);
-                    try {
-                        return Value::DOUBLE(std::stod(num_str));
-                    } catch (...) {
-                        return Value();
-                    }
+            LogicalType merged_type;
+            if (columns[column_idx].logical_type != column.logical_type &&
+                MergeOptionTypes(columns[column_idx].logical_type, column.logical_type, merged_type)) {
+                columns[column_idx].logical_type = merged_type;
+            } else if (columns[column_idx].logical_type != column.logical_type) {
+                if (!union_by_name) {
+                    throw BinderException("read_notion: column \"%s\" has type %s in database %s but %s in database %s "
+                                          "(set union_by_name = true to read it as VARCHAR)",
+                                          column.name, column.logical_type.ToString(), source.database_id,
+                                          columns[column_idx].logical_type.ToString(),
+                                          bind_data.sources[0].database_id);
                 }
+                columns[column_idx].logical_type = LogicalType::VARCHAR;
             }
         }
-    } else if (property_type == "checkbox") {
-        size_t checkbox_pos = json.find("\"checkbox\"", prop_pos);
-        if (checkbox_pos != std::string::npos) {
-            size_t true_pos = json.find("true", checkbox_pos);
-            size_t false_pos = json.find("false", checkbox_pos);
-            if (true_pos != std::string::npos && (false_pos == std::string::npos || true_pos < false_pos)) {
-                return Value::BOOLEAN(true);
+    }
+
+    for (idx_t source_idx = 0; source_idx < bind_data.sources.size(); source_idx++) {
+        auto &source = bind_data.sources[source_idx];
+        for (idx_t output_idx = 0; output_idx < columns.size(); output_idx++) {
+            // The output starts with the columns of the first database
+            if (source_idx == 0 && output_idx < source.columns.size()) {
+                source.column_map.push_back(output_idx);
+                continue;
             }
-            return Value::BOOLEAN(false);
-        }
-    } else if (property_type == "select") {
-        size_t select_pos = json.find("\"select\"", prop_pos);
-        if (select_pos != std::string::npos) {
-            size_t name_pos = json.find("\"name\"", select_pos);
-            if (name_pos != std::string::npos) {
-                size_t start = json.find("\"", name_pos + 6);
-                if (start != std::string::npos) {
-                    start++;
-                    size_t end = json.find("\"", start);
-                    if (end != std::string::npos) {
-                        return Value(json.substr(start, end - start));
-                    }
-                }
+            const auto &column = columns[output_idx];
+            auto column_idx = FindColumn(source.columns, column.name);
+            if (column_idx == DConstants::INVALID_INDEX && !union_by_name) {
+                throw BinderException("read_notion: database %s has no column \"%s\" "
+                                      "(set union_by_name = true to combine different columns)",
+                                      source.database_id, column.name);
             }
+            source.column_map.push_back(column_idx);
         }
-    } else if (property_type == "url") {
-        size_t url_pos = json.find("\"url\"", prop_pos);
-        if (url_pos != std::string::npos) {
-            size_t start = json.find("\"", url_pos + 5);
-            if (start != std::string::npos) {
-                start++;
-                size_t end = json.find("\"", start);
-                if (end != std::string::npos) {
-                    return Value(json.substr(start, end - start));
-                }
+    }
+}
+
+// Gives the relation columns their expanded type. A column combining a relation with another property
+// type across databases keeps its unified type.
+static void ExpandRelationColumns(NotionReadBindData &bind_data) {
+    for (idx_t output_idx = 0; output_idx < bind_data.columns.size(); output_idx++) {
+        auto &column = bind_data.columns[output_idx];
+        if (column.logical_type != LogicalType::LIST(LogicalType::VARCHAR)) {
+            continue;
+        }
+        bool is_relation = true;
+        for (const auto &source : bind_data.sources) {
+            auto column_idx = source.column_map[output_idx];
+            if (column_idx != DConstants::INVALID_INDEX &&
+                source.columns[column_idx].type != NotionPropertyType::RELATION) {
+                is_relation = false;
             }
         }
+        if (is_relation) {
+            column.logical_type = NotionRelationResolver::GetLogicalType();
+        }
     }
-
-    return Value();
 }
 
 static unique_ptr<FunctionData> NotionReadBind(ClientContext &context, TableFunctionBindInput &input,
                                                vector<LogicalType> &return_types, vector<string> &names) {
     auto bind_data = make_uniq<NotionReadBindData>();
-
-    // Get database ID from first parameter
-    std::string input_str = input.inputs[0].ToString();
-    bind_data->database_id = NotionUtils::ExtractDatabaseId(input_str);
+    auto database_ids = GetDatabaseIds(input.inputs[0]);
 
     // Get auth token
     bind_data->auth_token = NotionAuth::GetAuthToken(context);
 
-    // Query the database to get schema
-    auto db_response = NotionRequests::GetDatabase(bind_data->database_id, bind_data->auth_token);
+    bool union_by_name = false;
+    bool enum_types = true;
+    for (const auto &parameter : input.named_parameters) {
+        if (parameter.second.IsNull()) {
+            continue;
+        }
+        if (parameter.first == "edited_since") {
+            bind_data->has_edited_since = true;
+            bind_data->edited_since = parameter.second.GetValue<timestamp_t>();
+        } else if (parameter.first == "union_by_name") {
+            union_by_name = parameter.second.GetValue<bool>();
+        } else if (parameter.first == "database_id") {
+            bind_data->source_column = parameter.second.GetValue<bool>();
+        } else if (parameter.first == "expand_relations") {
+            bind_data->expand_relations = parameter.second.GetValue<bool>();
+        } else if (parameter.first == "enum_types") {
+            enum_types = parameter.second.GetValue<bool>();
+        }
+    }
 
-    if (!db_response.success) {
-        throw InvalidInputException("Failed to get Notion database schema: " + db_response.body);
+    // Start fetching the first pages while the schemas are requested. Scans served from the page
+    // cache do not need them, so they are skipped when the cache is enabled.
+    bool prefetch_first_page =
+        GetPrefetchDepth(context) > 0 && !bind_data->has_edited_since && !NotionPageCache::Create(context);
+    for (const auto &database_id : database_ids) {
+        NotionReadSource source;
+        source.database_id = database_id;
+        if (prefetch_first_page) {
+            source.first_page = NotionPendingQuery::Start(database_id, bind_data->auth_token, NotionQueryOptions());
+        }
+        bind_data->sources.push_back(std::move(source));
     }
 
-    // Parse properties from response
-    // This is a simplified parser - in production, use a proper JSON library
-    size_t props_pos = db_response.body.find("\"properties\"");
-    if (props_pos != std::string::npos) {
-        // For now, we'll create some default columns
-        // In a real implementation, parse the JSON to get actual column definitions
-        names.push_back("id");
-        return_types.push_back(LogicalType::VARCHAR);
+    // Query the databases to get their schemas
+    auto db_responses = NotionSchemaCache::Get(context).GetDatabases(context, database_ids, bind_data->auth_token);
+    for (idx_t i = 0; i < db_responses.size(); i++) {
+        if (!db_responses[i].success) {
+            throw InvalidInputException("Failed to get Notion database schema: " + db_responses[i].body);
+        }
+        // Derive the columns and their types from the database properties
+        auto properties = NotionSchema::ParseProperties(db_responses[i].body);
+        bind_data->sources[i].columns = NotionSchema::GetColumns(properties);
+        if (!enum_types) {
+            NotionSchema::UseTextTypes(bind_data->sources[i].columns);
+        }
+    }
 
-        // Add some common property types
-        names.push_back("title");
+    UnifyColumns(*bind_data, union_by_name);
+    if (bind_data->expand_relations) {
+        ExpandRelationColumns(*bind_data);
+    }
+    for (const auto &column : bind_data->columns) {
+        names.push_back(column.name);
+        return_types.push_back(column.logical_type);
+    }
+    if (bind_data->source_column) {
+        if (FindColumn(bind_data->columns, "database_id") != DConstants::INVALID_INDEX) {
+            throw BinderException("read_notion: database_id = true conflicts with a property named \"database_id\"");
+        }
+        names.push_back("database_id");
         return_types.push_back(LogicalType::VARCHAR);
+    }
 
-        names.push_back("created_time");
-        return_types.push_back(LogicalType::VARCHAR);
+    return std::move(bind_data);
+}
 
-        names.push_back("last_edited_time");
-        return_types.push_back(LogicalType::VARCHAR);
+// Starts a query for the first page of the query in the given created_time sort direction
+static NotionRequestFuture ProbeCreatedTime(const NotionReadBindData &bind_data, const NotionReadSource &source,
+                                            NotionQueryOptions options, const std::string &direction) {
+    options.sorts = "[{\"timestamp\":\"created_time\",\"direction\":\"" + direction + "\"}]";
+    options.page_size = 1;
+    // created_time is a page field, so a single property keeps the response small
+    if (options.filter_properties.size() > 1) {
+        options.filter_properties.resize(1);
     }
+    return NotionRequests::QueryDatabaseAsync(source.database_id, bind_data.auth_token, "", "", options);
+}
 
-    bind_data->column_names = names;
-    bind_data->column_types = return_types;
+// Reads the created_time of the page a probe found; false when the query matched no page
+static bool ReadProbedTime(ClientContext &context, const NotionReadSource &source, idx_t created_column,
+                           NotionResponse response, timestamp_t &result) {
+    if (!response.success) {
+        throw InvalidInputException("Failed to query Notion database: " + response.body);
+    }
+    auto page = NotionPageStream::ParseResponse(std::move(response.body));
+    if (page.results.empty()) {
+        return false;
+    }
 
-    return std::move(bind_data);
+    NotionPageDecoder decoder(source.columns, {created_column});
+    DataChunk chunk;
+    chunk.Initialize(context, {LogicalType::TIMESTAMP});
+    decoder.Decode(page.body.data() + page.results[0].offset, page.results[0].length, chunk, 0);
+    chunk.SetCardinality(1);
+    auto value = chunk.GetValue(0, 0);
+    if (value.IsNull()) {
+        return false;
+    }
+    result = value.GetValue<timestamp_t>();
+    return true;
 }
 
-static unique_ptr<GlobalTableFunctionState> NotionReadInit(ClientContext &context, TableFunctionInitInput &input) {
-    auto state = make_uniq<NotionReadGlobalState>();
-    return std::move(state);
-}
+// Splits the scan of a database into partition_count created_time ranges of equal length between
+// its oldest and newest page matching the query. Returns false when there is nothing to split.
+static bool PlanPartitions(ClientContext &context, const NotionReadBindData &bind_data, idx_t source_idx,
+                           const vector<std::string> &conditions, idx_t partition_count,
+                           NotionReadGlobalState &state) {
+    const auto &source = bind_data.sources[source_idx];
+    const auto &source_state = *state.sources[source_idx];
+    // Databases known to fit in a few pages are not worth the two probing requests
+    idx_t estimated_rows;
+    if (GetRowCountEstimate(context, source.database_id, estimated_rows) &&
+        estimated_rows < partition_count * NOTION_PAGE_SIZE) {
+        return false;
+    }
+    idx_t created_column = DConstants::INVALID_INDEX;
+    for (idx_t i = 0; i < source.columns.size(); i++) {
+        if (source.columns[i].type == NotionPropertyType::CREATED_TIME && !source.columns[i].is_property) {
+            created_column = i;
+        }
+    }
+    if (created_column == DConstants::INVALID_INDEX) {
+        // A property named "created_time" hides the page field
+        return false;
+    }
 
-static void NotionReadFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
-    auto &bind_data = data_p.bind_data->Cast<NotionReadBindData>();
-    auto &state = data_p.global_state->Cast<NotionReadGlobalState>();
+    // Both probes are in flight at once; their responses are read on this thread
+    auto oldest = ProbeCreatedTime(bind_data, source, source_state.query_options, "ascending");
+    auto newest = ProbeCreatedTime(bind_data, source, source_state.query_options, "descending");
+    timestamp_t first, last;
+    if (!ReadProbedTime(context, source, created_column, oldest.Get(), first) ||
+        !ReadProbedTime(context, source, created_column, newest.Get(), last)) {
+        return false;
+    }
 
-    if (!state.has_more && state.current_row >= state.results_buffer.size()) {
-        // No more data
-        return;
+    // Notion records created_time to the minute, so range boundaries are whole minutes
+    const int64_t minute = Interval::MICROS_PER_MINUTE;
+    int64_t start = first.value - first.value % minute;
+    int64_t width = (last.value - start) / int64_t(partition_count);
+    vector<timestamp_t> boundaries;
+    for (idx_t i = 1; i < partition_count; i++) {
+        int64_t boundary = start + int64_t(i) * width;
+        boundary -= boundary % minute;
+        if (boundary > start && boundary <= last.value && (boundaries.empty() || boundary > boundaries.back().value)) {
+            boundaries.push_back(timestamp_t(boundary));
+        }
+    }
+    if (boundaries.empty()) {
+        return false;
     }
 
-    // Fetch new page of results if needed
-    if (state.results_buffer.empty() || state.current_row >= state.results_buffer.size()) {
-        if (state.has_more) {
-            auto response = NotionRequests::QueryDatabase(bind_data.database_id,
-                                                         bind_data.auth_token,
-                                                         state.next_cursor);
+    // The outer ranges are open, so pages created during the scan still fall into one of them
+    for (idx_t i = 0; i <= boundaries.size(); i++) {
+        auto partition_conditions = conditions;
+        if (i > 0) {
+            partition_conditions.push_back(NotionFilter::CreatedOnOrAfter(boundaries[i - 1]));
+        }
+        if (i < boundaries.size()) {
+            partition_conditions.push_back(NotionFilter::CreatedBefore(boundaries[i]));
+        }
+        NotionReadPartition partition;
+        partition.source_idx = source_idx;
+        partition.options = source_state.query_options;
+        partition.options.filter = NotionFilter::Combine(partition_conditions);
+        state.partitions.push_back(std::move(partition));
+    }
+    return true;
+}
 
-            if (!response.success) {
-                throw InvalidInputException("Failed to query Notion database: " + response.body);
-            }
+static unique_ptr<GlobalTableFunctionState> NotionReadInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<NotionReadBindData>();
+    auto state = make_uniq<NotionReadGlobalState>();
+    state->auth_token = bind_data.auth_token;
+    state->row_counts = NotionRowCounts::Get(context);
+    state->row_count_cache = NotionPageCache::Create(context);
+
+    vector<idx_t> column_ids(input.column_ids.begin(), input.column_ids.end());
+    for (idx_t i = 0; i < column_ids.size(); i++) {
+        if (bind_data.source_column && column_ids[i] == bind_data.columns.size()) {
+            state->source_column_idx = i;
+        }
+        if (bind_data.expand_relations && column_ids[i] < bind_data.columns.size() &&
+            bind_data.columns[column_ids[i]].logical_type == NotionRelationResolver::GetLogicalType()) {
+            state->relation_columns.push_back(i);
+        }
+    }
+    if (!state->relation_columns.empty()) {
+        state->relations = make_uniq<NotionRelationResolver>(bind_data.auth_token, GetRelationConcurrency(context));
+    }
 
-            // Parse response
-            // Check for has_more
-            if (response.body.find("\"has_more\":true") != std::string::npos) {
-                state.has_more = true;
-                // Extract next_cursor
-                state.next_cursor = NotionUtils::ParseJsonString(response.body, "next_cursor");
+    // Filters are evaluated locally on the output columns, and translated per database
+    if (input.filters) {
+        for (const auto &entry : input.filters->filters) {
+            state->filters.push_back({entry.first, entry.second.get()});
+        }
+        vector<LogicalType> output_types;
+        for (auto column_id : column_ids) {
+            if (column_id < bind_data.columns.size()) {
+                output_types.push_back(bind_data.columns[column_id].logical_type);
+            } else if (bind_data.source_column && column_id == bind_data.columns.size()) {
+                output_types.push_back(LogicalType::VARCHAR);
             } else {
-                state.has_more = false;
+                output_types.push_back(LogicalType::ROW_TYPE);
+            }
+        }
+        state->filter_expression = NotionFilter::ToExpression(state->filters, output_types);
+    }
+
+    auto partition_count = GetScanPartitions(context);
+    bool estimate_known = true;
+    for (idx_t source_idx = 0; source_idx < bind_data.sources.size(); source_idx++) {
+        const auto &source = bind_data.sources[source_idx];
+        state->sources.push_back(make_uniq<NotionReadSourceState>());
+        auto &source_state = *state->sources.back();
+        source_state.database_id = source.database_id;
+
+        // A filter on the database_id column skips whole databases
+        bool skip = false;
+        for (const auto &filter : state->filters) {
+            if (filter.output_idx == state->source_column_idx &&
+                !NotionFilter::Matches(context, *filter.filter, Value(source.database_id))) {
+                skip = true;
+            }
+        }
+        if (skip) {
+            continue;
+        }
+
+        idx_t estimated_rows;
+        if (GetRowCountEstimate(context, source.database_id, estimated_rows)) {
+            state->estimated_rows += estimated_rows;
+        } else {
+            estimate_known = false;
+        }
+
+        // Only the projected columns are decoded, and only their properties are requested
+        for (auto column_id : column_ids) {
+            auto source_column_id = DConstants::INVALID_INDEX;
+            LogicalType output_type = LogicalType::VARCHAR;
+            if (column_id < bind_data.columns.size()) {
+                source_column_id = source.column_map[column_id];
+                output_type = bind_data.columns[column_id].logical_type;
             }
+            source_state.column_ids.push_back(source_column_id);
+            if (source_column_id == DConstants::INVALID_INDEX) {
+                source_state.decode_types.push_back(output_type);
+                continue;
+            }
+            const auto &column = source.columns[source_column_id];
+            source_state.decode_types.push_back(column.logical_type);
+            if (column.logical_type != output_type) {
+                source_state.direct = false;
+            }
+            if (column.is_property) {
+                source_state.query_options.filter_properties.push_back(column.property_id);
+            }
+        }
+        if (source_state.query_options.filter_properties.empty()) {
+            // No property is needed (e.g. only the page id): ask for a single one rather than all
+            for (const auto &column : source.columns) {
+                if (column.is_property) {
+                    source_state.query_options.filter_properties.push_back(column.property_id);
+                    break;
+                }
+            }
+        }
 
-            // Parse results array
-            size_t results_pos = response.body.find("\"results\"");
-            if (results_pos != std::string::npos) {
-                // Find the array start
-                size_t array_start = response.body.find("[", results_pos);
-                if (array_start != std::string::npos) {
-                    // Simple array parsing - extract each object
-                    size_t pos = array_start + 1;
-                    int brace_count = 0;
-                    size_t obj_start = 0;
-
-                    for (size_t i = pos; i < response.body.length(); i++) {
-                        if (response.body[i] == '{') {
-                            if (brace_count == 0) {
-                                obj_start = i;
-                            }
-                            brace_count++;
-                        } else if (response.body[i] == '}') {
-                            brace_count--;
-                            if (brace_count == 0) {
-                                state.results_buffer.push_back(response.body.substr(obj_start, i - obj_start + 1));
-                            }
-                        } else if (response.body[i] == ']' && brace_count == 0) {
-                            break;
-                        }
-                    }
+        // Translate what we can of the pushed-down filters into the Notion query filter
+        vector<std::string> conditions;
+        if (bind_data.has_edited_since) {
+            conditions.push_back(NotionFilter::EditedSince(bind_data.edited_since));
+        }
+        if (input.filters) {
+            for (const auto &entry : input.filters->filters) {
+                auto column_id = input.column_ids[entry.first];
+                if (column_id >= bind_data.columns.size() ||
+                    source.column_map[column_id] == DConstants::INVALID_INDEX) {
+                    continue;
+                }
+                const auto &column = source.columns[source.column_map[column_id]];
+                // Constants are typed for the output column, which only matches when no cast is needed.
+                // Options are compared by name, whatever the type of the constant.
+                if (column.logical_type == bind_data.columns[column_id].logical_type ||
+                    column.logical_type.id() == LogicalTypeId::ENUM) {
+                    NotionFilter::Translate(*entry.second, column, conditions);
                 }
             }
+        }
+        source_state.query_options.filter = NotionFilter::Combine(conditions);
+
+        auto partitions_before = state->partitions.size();
+        if (partition_count <= 1 ||
+            !PlanPartitions(context, bind_data, source_idx, conditions, partition_count, *state)) {
+            NotionReadPartition partition;
+            partition.source_idx = source_idx;
+            partition.options = source_state.query_options;
+            // The first page fetched at bind holds every property and can stand in for the projected
+            // query, but it cannot be used once filters change the cursor chain
+            if (partition.options.filter.empty() && source.first_page && source.first_page->Claim()) {
+                partition.first_page = source.first_page;
+            }
+            state->partitions.push_back(std::move(partition));
+        }
+        source_state.partitions_left = state->partitions.size() - partitions_before;
+    }
+    if (!estimate_known) {
+        state->estimated_rows = 0;
+    }
 
-            state.current_row = 0;
+    return std::move(state);
+}
+
+static unique_ptr<LocalTableFunctionState> NotionReadInitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+                                                             GlobalTableFunctionState *global_state) {
+    auto &gstate = global_state->Cast<NotionReadGlobalState>();
+    auto state = make_uniq<NotionReadLocalState>();
+    if (gstate.filter_expression) {
+        state->filter_executor = make_uniq<ExpressionExecutor>(context.client, *gstate.filter_expression);
+    }
+    return std::move(state);
+}
+
+// Starts reading the next unclaimed partition; returns false when none are left
+static bool NextPartition(ClientContext &context, const NotionReadBindData &bind_data, NotionReadGlobalState &gstate,
+                          NotionReadLocalState &lstate) {
+    auto partition_idx = gstate.next_partition++;
+    if (partition_idx >= gstate.partitions.size()) {
+        return false;
+    }
+    // Each partition is claimed by a single thread, which takes over its first page
+    auto &partition = gstate.partitions[partition_idx];
+    const auto &source = bind_data.sources[partition.source_idx];
+    const auto &source_state = *gstate.sources[partition.source_idx];
+    if (partition.source_idx != lstate.source_idx) {
+        lstate.source_idx = partition.source_idx;
+        lstate.decoder = make_uniq<NotionPageDecoder>(source.columns, source_state.column_ids);
+        lstate.decode_chunk.reset();
+        if (!source_state.direct) {
+            lstate.decode_chunk = make_uniq<DataChunk>();
+            lstate.decode_chunk->Initialize(context, source_state.decode_types);
         }
     }
+    lstate.stream = make_uniq<NotionPageStream>(source.database_id, gstate.auth_token, partition.options,
+                                                GetPrefetchDepth(context), std::move(partition.first_page),
+                                                NotionPageCache::Create(context));
+    return true;
+}
 
-    // Output rows
-    idx_t count = 0;
-    while (count < STANDARD_VECTOR_SIZE && state.current_row < state.results_buffer.size()) {
-        const auto &result_obj = state.results_buffer[state.current_row];
+// Completes a chunk of rows of the thread's current database
+static void FinishChunk(ClientContext &context, NotionReadGlobalState &gstate, NotionReadLocalState &lstate,
+                        DataChunk &output, idx_t count) {
+    auto &source_state = *gstate.sources[lstate.source_idx];
+    if (lstate.decode_chunk) {
+        // Relation ids are decoded as lists of strings and expanded together
+        vector<reference<Vector>> relation_ids;
+        vector<reference<Vector>> relation_results;
+        for (idx_t i = 0; i < output.ColumnCount(); i++) {
+            auto &decoded = lstate.decode_chunk->data[i];
+            if (decoded.GetType() == output.data[i].GetType()) {
+                output.data[i].Reference(decoded);
+            } else if (std::find(gstate.relation_columns.begin(), gstate.relation_columns.end(), i) !=
+                       gstate.relation_columns.end()) {
+                relation_ids.push_back(decoded);
+                relation_results.push_back(output.data[i]);
+            } else {
+                VectorOperations::Cast(context, decoded, output.data[i], count);
+            }
+        }
+        if (!relation_ids.empty()) {
+            gstate.relations->Expand(relation_ids, relation_results, count);
+        }
+    }
+    if (gstate.source_column_idx != DConstants::INVALID_INDEX) {
+        output.data[gstate.source_column_idx].Reference(Value(source_state.database_id));
+    }
+    source_state.rows_read += count;
+    gstate.rows_read += count;
+}
 
-        // Extract id
-        std::string id = NotionUtils::ParseJsonString(result_obj, "id");
-        output.SetValue(0, count, Value(id));
+static void NotionReadFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &bind_data = data_p.bind_data->Cast<NotionReadBindData>();
+    auto &gstate = data_p.global_state->Cast<NotionReadGlobalState>();
+    auto &state = data_p.local_state->Cast<NotionReadLocalState>();
+
+    // Keep filling until some rows survive the local filters or the pages run out
+    do {
+        output.Reset();
+        if (state.decode_chunk) {
+            state.decode_chunk->Reset();
+        }
 
-        // Extract title (simplified - would need to parse properties properly)
-        output.SetValue(1, count, Value(""));
+        idx_t count = 0;
+        // Decoding time per chunk, excluding waits for the next page
+        uint64_t decode_micros = 0;
+        while (count < STANDARD_VECTOR_SIZE) {
+            // Take the next (usually already prefetched) page once the current one is drained
+            if (state.current_row >= state.page.results.size()) {
+                if (state.finished) {
+                    break;
+                }
+                if (state.stream && state.stream->Next(state.page)) {
+                    state.current_row = 0;
+                    continue;
+                }
+                if (state.stream) {
+                    state.stream.reset();
+                    gstate.sources[state.source_idx]->partitions_left--;
+                }
+                // A chunk holds the rows of a single database
+                if (count > 0) {
+                    break;
+                }
+                if (!NextPartition(context, bind_data, gstate, state)) {
+                    state.finished = true;
+                    break;
+                }
+                continue;
+            }
+
+            // Walk the page object once, writing each property straight into its column vector
+            const auto &result = state.page.results[state.current_row];
+            auto &target = state.decode_chunk ? *state.decode_chunk : output;
+            auto decode_start = std::chrono::steady_clock::now();
+            state.decoder->Decode(state.page.body.data() + result.offset, result.length, target, count);
+            decode_micros += NotionStats::ElapsedMicros(decode_start);
+            if (state.decoder->TakeUnknownOptions()) {
+                // The option is read as NULL by this scan; the next bind reads the schema again
+                NotionSchemaCache::Get(context).Invalidate(gstate.sources[state.source_idx]->database_id);
+            }
 
-        // Extract created_time
-        std::string created_time = NotionUtils::ParseJsonString(result_obj, "created_time");
-        output.SetValue(2, count, Value(created_time));
+            count++;
+            state.current_row++;
+        }
 
-        // Extract last_edited_time
-        std::string last_edited_time = NotionUtils::ParseJsonString(result_obj, "last_edited_time");
-        output.SetValue(3, count, Value(last_edited_time));
+        output.SetCardinality(count);
+        if (count > 0) {
+            FinishChunk(context, gstate, state, output, count);
+            NotionStats::Get().Record(NotionStatPhase::DECODE, decode_micros);
+        }
+        if (state.filter_executor) {
+            NotionFilter::Apply(*state.filter_executor, output);
+        }
+    } while (output.size() == 0 && !state.finished);
+}
 
-        count++;
-        state.current_row++;
+static unique_ptr<NodeStatistics> NotionReadCardinality(ClientContext &context, const FunctionData *bind_data_p) {
+    auto &bind_data = bind_data_p->Cast<NotionReadBindData>();
+    idx_t total_rows = 0;
+    for (const auto &source : bind_data.sources) {
+        idx_t row_count;
+        if (!GetRowCountEstimate(context, source.database_id, row_count)) {
+            return make_uniq<NodeStatistics>();
+        }
+        total_rows += row_count;
     }
+    return make_uniq<NodeStatistics>(total_rows);
+}
 
-    output.SetCardinality(count);
+static double NotionReadProgress(ClientContext &context, const FunctionData *bind_data_p,
+                                 const GlobalTableFunctionState *global_state) {
+    auto &state = global_state->Cast<NotionReadGlobalState>();
+    if (state.estimated_rows == 0) {
+        // Unknown until every database was scanned once
+        return -1;
+    }
+    return MinValue(100.0, 100.0 * double(state.rows_read) / double(state.estimated_rows));
 }
 
-void NotionRead::RegisterTableFunction(DatabaseInstance &db) {
-    TableFunction read_notion("read_notion", {LogicalType::VARCHAR}, NotionReadFunction, NotionReadBind, NotionReadInit);
-    read_notion.name = "read_notion";
+static TableFunction MakeReadFunction(const LogicalType &argument) {
+    TableFunction function("read_notion", {argument}, NotionReadFunction, NotionReadBind, NotionReadInit,
+                           NotionReadInitLocal);
+    function.filter_pushdown = true;
+    function.projection_pushdown = true;
+    function.named_parameters["edited_since"] = LogicalType::TIMESTAMP;
+    function.named_parameters["union_by_name"] = LogicalType::BOOLEAN;
+    function.named_parameters["database_id"] = LogicalType::BOOLEAN;
+    function.named_parameters["expand_relations"] = LogicalType::BOOLEAN;
+    function.named_parameters["enum_types"] = LogicalType::BOOLEAN;
+    function.cardinality = NotionReadCardinality;
+    function.table_scan_progress = NotionReadProgress;
+    return function;
+}
+
+TableFunction NotionRead::GetFunction() {
+    return MakeReadFunction(LogicalType::VARCHAR);
+}
+
+unique_ptr<FunctionData> NotionRead::BindTable(ClientContext &context, const std::string &database_id,
+                                               const vector<NotionColumn> &columns) {
+    auto bind_data = make_uniq<NotionReadBindData>();
+    bind_data->auth_token = NotionAuth::GetAuthToken(context);
+    bind_data->columns = columns;
 
+    NotionReadSource source;
+    source.database_id = database_id;
+    source.columns = columns;
+    for (idx_t i = 0; i < columns.size(); i++) {
+        source.column_map.push_back(i);
+    }
+    // The schema is known, so the first page is the only request left to start at bind
+    if (GetPrefetchDepth(context) > 0 && !NotionPageCache::Create(context)) {
+        source.first_page = NotionPendingQuery::Start(database_id, bind_data->auth_token, NotionQueryOptions());
+    }
+    bind_data->sources.push_back(std::move(source));
+    return std::move(bind_data);
+}
+
+void NotionRead::RegisterTableFunction(DatabaseInstance &db) {
+    // A single database, or a list of databases read in one parallel scan
+    TableFunctionSet read_notion("read_notion");
+    read_notion.AddFunction(MakeReadFunction(LogicalType::VARCHAR));
+    read_notion.AddFunction(MakeReadFunction(LogicalType::LIST(LogicalType::VARCHAR)));
     ExtensionUtil::RegisterFunction(db, read_notion);
 }
 
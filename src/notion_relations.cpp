@@ -0,0 +1,165 @@
+#include "notion_relations.hpp"
+#include "notion_decoder.hpp"
+#include "notion_json.hpp"
+#include "notion_requests.hpp"
+#include "duckdb/common/exception.hpp"
+#include <deque>
+
+namespace duckdb {
+
+NotionRelationResolver::NotionRelationResolver(std::string auth_token_p, idx_t concurrency_p)
+    : auth_token(std::move(auth_token_p)), concurrency(MaxValue<idx_t>(concurrency_p, 1)) {
+}
+
+LogicalType NotionRelationResolver::GetLogicalType() {
+    child_list_t<LogicalType> fields;
+    fields.push_back(make_pair("id", LogicalType::VARCHAR));
+    fields.push_back(make_pair("title", LogicalType::VARCHAR));
+    return LogicalType::LIST(LogicalType::STRUCT(std::move(fields)));
+}
+
+// Reads the title property of a page object: the only property with a "title" member
+static Value ParseTitle(const std::string &body) {
+    NotionJsonCursor cursor(body);
+    if (!cursor.EnterObject() || !cursor.FindKey("properties") || !cursor.EnterObject()) {
+        return Value();
+    }
+    NotionJsonString property_name;
+    while (cursor.NextKey(property_name)) {
+        if (!cursor.EnterObject()) {
+            continue;
+        }
+        NotionJsonString key;
+        while (cursor.NextKey(key)) {
+            if (!key.Equals("title")) {
+                cursor.SkipValue();
+                continue;
+            }
+            // A title without text is NULL, as in the title column of read_notion
+            std::string title;
+            if (!NotionPageDecoder::ReadRichText(cursor, title)) {
+                return Value();
+            }
+            return Value(title);
+        }
+    }
+    return Value();
+}
+
+Value NotionRelationResolver::ReadTitle(NotionResponse response) {
+    if (!response.success) {
+        // Related pages can live in databases that are not shared with the integration
+        if (response.status_code == 403 || response.status_code == 404) {
+            return Value();
+        }
+        throw InvalidInputException("Failed to read related Notion page: " + response.body);
+    }
+    return ParseTitle(response.body);
+}
+
+void NotionRelationResolver::Resolve(const vector<std::string> &page_ids,
+                                     std::unordered_map<std::string, Value> &titles) {
+    vector<std::pair<std::string, std::promise<Value>>> owned;
+    vector<std::pair<std::string, std::shared_future<Value>>> lookups;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (const auto &page_id : page_ids) {
+            auto entry = pages.find(page_id);
+            if (entry != pages.end()) {
+                lookups.emplace_back(page_id, entry->second);
+                continue;
+            }
+            owned.emplace_back(page_id, std::promise<Value>());
+            auto title = owned.back().second.get_future().share();
+            pages[page_id] = title;
+            lookups.emplace_back(page_id, title);
+        }
+    }
+
+    // This thread owns the lookups it started, keeping up to concurrency of them in flight;
+    // pages other threads are requesting are waited for
+    std::deque<std::pair<idx_t, NotionRequestFuture>> in_flight;
+    auto finish_lookup = [&]() {
+        auto &lookup = in_flight.front();
+        auto &promise = owned[lookup.first].second;
+        try {
+            promise.set_value(ReadTitle(lookup.second.Get()));
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+        in_flight.pop_front();
+    };
+    for (idx_t i = 0; i < owned.size(); i++) {
+        if (in_flight.size() >= concurrency) {
+            finish_lookup();
+        }
+        // The title property always has the id "title", so it is the only one requested
+        in_flight.emplace_back(i, NotionRequests::GetPageAsync(owned[i].first, auth_token, {"title"}));
+    }
+    while (!in_flight.empty()) {
+        finish_lookup();
+    }
+
+    for (auto &lookup : lookups) {
+        titles[lookup.first] = lookup.second.get();
+    }
+}
+
+void NotionRelationResolver::Expand(const vector<reference<Vector>> &ids, const vector<reference<Vector>> &results,
+                                    idx_t count) {
+    // The distinct related pages of the chunk, across all relation columns
+    std::unordered_map<std::string, Value> titles;
+    vector<std::string> page_ids;
+    for (auto &vector_ref : ids) {
+        auto &id_vector = vector_ref.get();
+        auto entries = FlatVector::GetData<list_entry_t>(id_vector);
+        auto id_data = FlatVector::GetData<string_t>(ListVector::GetEntry(id_vector));
+        for (idx_t row = 0; row < count; row++) {
+            if (!FlatVector::Validity(id_vector).RowIsValid(row)) {
+                continue;
+            }
+            for (idx_t i = entries[row].offset; i < entries[row].offset + entries[row].length; i++) {
+                auto page_id = id_data[i].GetString();
+                if (titles.emplace(page_id, Value()).second) {
+                    page_ids.push_back(std::move(page_id));
+                }
+            }
+        }
+    }
+    Resolve(page_ids, titles);
+
+    // The expanded lists have the same entries as the id lists
+    for (idx_t column_idx = 0; column_idx < ids.size(); column_idx++) {
+        auto &id_vector = ids[column_idx].get();
+        auto &result = results[column_idx].get();
+        auto list_size = ListVector::GetListSize(id_vector);
+        auto id_data = FlatVector::GetData<string_t>(ListVector::GetEntry(id_vector));
+        auto entries = FlatVector::GetData<list_entry_t>(id_vector);
+
+        ListVector::Reserve(result, list_size);
+        auto &fields = StructVector::GetEntries(ListVector::GetEntry(result));
+        auto &id_field = *fields[0];
+        auto &title_field = *fields[1];
+        auto result_entries = FlatVector::GetData<list_entry_t>(result);
+        for (idx_t row = 0; row < count; row++) {
+            if (!FlatVector::Validity(id_vector).RowIsValid(row)) {
+                FlatVector::SetNull(result, row, true);
+                continue;
+            }
+            result_entries[row] = entries[row];
+        }
+        for (idx_t i = 0; i < list_size; i++) {
+            FlatVector::GetData<string_t>(id_field)[i] = StringVector::AddString(id_field, id_data[i]);
+            auto title = titles.find(id_data[i].GetString());
+            if (title == titles.end() || title->second.IsNull()) {
+                FlatVector::SetNull(title_field, i, true);
+                continue;
+            }
+            FlatVector::GetData<string_t>(title_field)[i] =
+                StringVector::AddString(title_field, StringValue::Get(title->second));
+        }
+        ListVector::SetListSize(result, list_size);
+    }
+}
+
+} // namespace duckdb
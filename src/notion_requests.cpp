@@ -1,63 +1,112 @@
 #include "notion_requests.hpp"
+#include "notion_connection_pool.hpp"
+#include "notion_rate_limiter.hpp"
+#include "notion_stats.hpp"
+#include "notion_transport.hpp"
+#include "notion_utils.hpp"
+#include "duckdb/common/exception.hpp"
 #include <openssl/ssl.h>
 #include <openssl/bio.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <random>
 #include <sstream>
+#include <thread>
 
 namespace duckdb {
 
-static const std::string NOTION_API_BASE = "https://api.notion.com/v1";
 static const std::string NOTION_VERSION = "2025-09-03";
 
-NotionResponse NotionRequests::MakeRequest(const std::string &url,
-                                           const std::string &auth_token,
-                                           const std::string &method,
-                                           const std::string &body) {
-    NotionResponse response;
-    response.success = false;
-    response.status_code = 0;
+// Backoff before the first retry of a transient failure; doubles with every further attempt
+static constexpr double RETRY_BASE_DELAY_SECONDS = 0.5;
+static constexpr double RETRY_MAX_DELAY_SECONDS = 30.0;
 
-    // Parse URL to extract host and path
-    std::string host = "api.notion.com";
-    std::string path = url;
-    if (url.find("https://") == 0) {
-        size_t host_start = 8; // After "https://"
-        size_t path_start = url.find("/", host_start);
-        if (path_start != std::string::npos) {
-            host = url.substr(host_start, path_start - host_start);
-            path = url.substr(path_start);
-        }
-    }
+static std::atomic<idx_t> max_retries {NotionRequests::DEFAULT_MAX_RETRIES};
 
-    // Initialize SSL context
-    SSL_CTX *ctx = SSL_CTX_new(TLS_client_method());
-    if (!ctx) {
-        response.body = "Failed to create SSL context";
-        return response;
-    }
+void NotionRequests::SetMaxRetries(ClientContext &context, SetScope scope, Value &parameter) {
+    NotionUtils::CheckGlobalScope(scope, "notion_max_retries");
+    max_retries = parameter.GetValue<uint64_t>();
+}
 
-    // Create BIO connection
-    BIO *bio = BIO_new_ssl_connect(ctx);
-    if (!bio) {
-        SSL_CTX_free(ctx);
-        response.body = "Failed to create BIO";
-        return response;
+static std::mutex base_url_lock;
+static std::string base_url = NotionRequests::DEFAULT_API_BASE_URL;
+
+void NotionRequests::SetBaseUrl(ClientContext &context, SetScope scope, Value &parameter) {
+    // Every request carries its bearer token to this host, so one session must not redirect
+    // the requests of the others
+    NotionUtils::CheckGlobalScope(scope, "notion_api_base_url");
+    auto url = parameter.ToString();
+    if (url.find("https://") != 0 && url.find("http://") != 0) {
+        throw InvalidInputException("notion_api_base_url must start with https:// or http://");
     }
+    // Endpoint paths are appended with their leading slash
+    while (!url.empty() && url.back() == '/') {
+        url.pop_back();
+    }
+    std::lock_guard<std::mutex> guard(base_url_lock);
+    base_url = url;
+}
 
-    // Set up connection
-    BIO_set_conn_hostname(bio, (host + ":443").c_str());
+std::string NotionRequests::GetBaseUrl() {
+    std::lock_guard<std::mutex> guard(base_url_lock);
+    return base_url;
+}
+
+// Reads one HTTP/1.1 response from a blocking connection.
+// Sets received when any byte arrived and keep_alive when the connection can be reused.
+static bool ReadResponse(BIO *bio, NotionResponse &response, bool &received, bool &keep_alive) {
+    auto &stats = NotionStats::Get();
+    auto phase_start = std::chrono::steady_clock::now();
+    NotionHttpParser parser;
+    received = false;
+    keep_alive = false;
+
+    bool complete = false;
+    while (!complete) {
+        bool headers_read = parser.HeadersRead();
+        auto buffer = parser.Reserve(NotionHttpParser::READ_SIZE);
+        int bytes_read = BIO_read(bio, buffer, static_cast<int>(NotionHttpParser::READ_SIZE));
+        if (bytes_read <= 0) {
+            // The server closed the connection, which ends an unframed body
+            parser.Commit(0);
+            if (!parser.Close()) {
+                return false;
+            }
+            break;
+        }
+        received = true;
+        complete = parser.Commit(bytes_read);
+        if (parser.Failed()) {
+            return false;
+        }
+        if (!headers_read && parser.HeadersRead()) {
+            stats.Record(NotionStatPhase::TIME_TO_FIRST_BYTE, NotionStats::ElapsedMicros(phase_start));
+            phase_start = std::chrono::steady_clock::now();
+        }
+    }
+    stats.Record(NotionStatPhase::TRANSFER, NotionStats::ElapsedMicros(phase_start));
 
-    // Get SSL pointer
-    SSL *ssl;
-    BIO_get_ssl(bio, &ssl);
-    SSL_set_mode(ssl, SSL_MODE_AUTO_RETRY);
+    keep_alive = parser.KeepAlive();
+    response = parser.TakeResponse();
+    return true;
+}
 
-    // Connect
-    if (BIO_do_connect(bio) <= 0) {
-        BIO_free_all(bio);
-        SSL_CTX_free(ctx);
-        response.body = "Failed to connect to Notion API";
-        return response;
+// Splits url into its host (with optional port) and scheme and serializes the HTTP request.
+// Returns false for a URL that cannot be requested.
+static bool BuildRequest(const std::string &url, const std::string &auth_token, const std::string &method,
+                         const std::string &body, std::string &host, bool &secure, std::string &request_str) {
+    // Parse URL to extract scheme, host (with optional port) and path
+    secure = url.find("https://") == 0;
+    size_t host_start = secure ? 8 : url.find("://") + 3;
+    size_t path_start = url.find("/", host_start);
+    if (url.find("://") == std::string::npos || path_start == std::string::npos) {
+        return false;
     }
+    host = url.substr(host_start, path_start - host_start);
+    std::string path = url.substr(path_start);
 
     // Prepare HTTP request
     std::stringstream request;
@@ -66,66 +115,357 @@ NotionResponse NotionRequests::MakeRequest(const std::string &url,
     request << "Authorization: Bearer " << auth_token << "\r\n";
     request << "Notion-Version: " << NOTION_VERSION << "\r\n";
     request << "Content-Type: application/json\r\n";
+    request << "Accept-Encoding: gzip\r\n";
     if (!body.empty()) {
         request << "Content-Length: " << body.length() << "\r\n";
     }
-    request << "Connection: close\r\n";
+    request << "Connection: keep-alive\r\n";
     request << "\r\n";
     if (!body.empty()) {
         request << body;
     }
+    request_str = request.str();
+    return true;
+}
 
-    std::string request_str = request.str();
+NotionResponse NotionRequests::SendRequest(const std::string &url,
+                                           const std::string &auth_token,
+                                           const std::string &method,
+                                           const std::string &body,
+                                           bool &delivered) {
+    NotionResponse response;
+    response.success = false;
+    response.status_code = 0;
 
-    // Send request
-    if (BIO_write(bio, request_str.c_str(), request_str.length()) <= 0) {
-        BIO_free_all(bio);
-        SSL_CTX_free(ctx);
-        response.body = "Failed to send request";
+    std::string host;
+    bool secure;
+    std::string request_str;
+    if (!BuildRequest(url, auth_token, method, body, host, secure, request_str)) {
+        response.body = "Invalid Notion API URL: " + url;
         return response;
     }
+    auto &pool = NotionConnectionPool::Get();
+
+    // A pooled connection may have been closed by the server while idle; in that case
+    // nothing was received and the request is retried once on a fresh connection.
+    for (int attempt = 0; attempt < 2; attempt++) {
+        std::string error;
+        auto acquire_start = std::chrono::steady_clock::now();
+        auto connection = pool.Acquire(host, secure, error);
+        if (!connection) {
+            response.body = error;
+            return response;
+        }
+        if (!connection->reused) {
+            NotionStats::Get().Record(NotionStatPhase::CONNECT, NotionStats::ElapsedMicros(acquire_start));
+        }
+
+        // Send request
+        bool received = false;
+        bool keep_alive = false;
+        bool sent = BIO_write(connection->bio, request_str.c_str(), request_str.length()) > 0;
+        delivered = delivered || sent;
+        if (sent && ReadResponse(connection->bio, response, received, keep_alive)) {
+            response.success = (response.status_code >= 200 && response.status_code < 300);
+            pool.Release(std::move(connection), keep_alive);
+            return response;
+        }
 
-    // Read response
-    char buffer[4096];
-    std::stringstream response_stream;
-    int bytes_read;
-    while ((bytes_read = BIO_read(bio, buffer, sizeof(buffer) - 1)) > 0) {
-        buffer[bytes_read] = '\0';
-        response_stream << buffer;
+        bool stale = connection->reused && !received;
+        if (stale) {
+            // The server closed the connection before reading the request
+            delivered = false;
+        }
+        pool.Release(std::move(connection), false);
+        response.status_code = 0;
+        response.body = sent ? "Failed to read response from Notion API" : "Failed to send request";
+        if (!stale) {
+            break;
+        }
     }
 
-    // Clean up
-    BIO_free_all(bio);
-    SSL_CTX_free(ctx);
+    return response;
+}
 
-    std::string full_response = response_stream.str();
+// Rate limiting and transient server errors are worth retrying; other failures are final
+static bool IsRetryableStatus(int status_code) {
+    return status_code == 429 || status_code == 500 || status_code == 502 || status_code == 503 ||
+           status_code == 504;
+}
 
-    // Parse HTTP response
-    size_t header_end = full_response.find("\r\n\r\n");
-    if (header_end != std::string::npos) {
-        std::string headers = full_response.substr(0, header_end);
-        response.body = full_response.substr(header_end + 4);
+// Full jitter: a random delay up to the exponential backoff of this attempt, so that
+// concurrent requests that failed together do not retry together
+static double BackoffDelay(idx_t attempt) {
+    thread_local std::mt19937 generator(std::random_device {}());
+    double max_delay = std::min(RETRY_MAX_DELAY_SECONDS, RETRY_BASE_DELAY_SECONDS * std::pow(2.0, attempt));
+    return std::uniform_real_distribution<double>(0, max_delay)(generator);
+}
 
-        // Extract status code
-        size_t status_pos = headers.find(" ");
-        if (status_pos != std::string::npos) {
-            std::string status_str = headers.substr(status_pos + 1, 3);
-            response.status_code = std::stoi(status_str);
-            response.success = (response.status_code >= 200 && response.status_code < 300);
+static NotionResponse CancelledResponse() {
+    NotionResponse response;
+    response.success = false;
+    response.status_code = 0;
+    response.body = NotionRequests::CANCELLED_MESSAGE;
+    return response;
+}
+
+// Sleeps until the given time; returns false as soon as the request was cancelled instead
+static bool SleepUntil(std::chrono::steady_clock::time_point until, const std::atomic<bool> *cancelled) {
+    if (!cancelled) {
+        std::this_thread::sleep_until(until);
+        return true;
+    }
+    static constexpr auto CANCEL_CHECK_INTERVAL = std::chrono::milliseconds(20);
+    while (!*cancelled) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= until) {
+            return true;
         }
-    } else {
-        response.body = full_response;
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(until - now, CANCEL_CHECK_INTERVAL));
     }
+    return false;
+}
 
-    return response;
+NotionResponse NotionRequests::MakeBlockingRequest(const std::string &url,
+                                                   const std::string &auth_token,
+                                                   const std::string &method,
+                                                   const std::string &body,
+                                                   bool idempotent,
+                                                   const std::atomic<bool> *cancelled) {
+    auto &limiter = NotionRateLimiter::ForToken(auth_token);
+    auto &stats = NotionStats::Get();
+    auto request_start = std::chrono::steady_clock::now();
+    idx_t retries = max_retries;
+
+    for (idx_t attempt = 0;; attempt++) {
+        auto wait_start = std::chrono::steady_clock::now();
+        if (!SleepUntil(limiter.Reserve(), cancelled)) {
+            limiter.Release();
+            return CancelledResponse();
+        }
+        stats.Record(NotionStatPhase::RATE_LIMIT_WAIT, NotionStats::ElapsedMicros(wait_start));
+
+        bool delivered = false;
+        auto response = SendRequest(url, auth_token, method, body, delivered);
+        // Retry decisions below may end the request; every exit records it once
+        auto finish = [&]() {
+            stats.RecordRequest(method, url, response.status_code, attempt, NotionStats::ElapsedMicros(request_start),
+                                response.body.size());
+            return std::move(response);
+        };
+        if (response.success || attempt >= retries) {
+            return finish();
+        }
+
+        if (response.status_code == 429) {
+            // Rejected before processing: always safe to retry. Hold back every request made
+            // with this token, not just this one, until the server is ready again.
+            double delay = response.retry_after > 0 ? response.retry_after : BackoffDelay(attempt);
+            limiter.Pause(delay);
+            continue;
+        }
+
+        bool transient = response.status_code == 0 || IsRetryableStatus(response.status_code);
+        // A request that reached the server may have been applied even though it failed
+        if (!transient || (!idempotent && delivered)) {
+            return finish();
+        }
+        auto delay = BackoffDelay(attempt);
+        auto retry_at = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(delay));
+        if (!SleepUntil(retry_at, cancelled)) {
+            return finish();
+        }
+        stats.Record(NotionStatPhase::RETRY_BACKOFF, static_cast<uint64_t>(delay * 1000000));
+    }
 }
 
-NotionResponse NotionRequests::QueryDatabase(const std::string &database_id,
-                                             const std::string &auth_token,
-                                             const std::string &start_cursor,
-                                             const std::string &data_source_id) {
-    std::string url = NOTION_API_BASE + "/databases/" + database_id + "/query";
+// A request sent through the event loop transport. Each attempt is scheduled at the time the
+// rate limiter (or the retry backoff) allows, and its response is handled on an I/O thread.
+struct NotionAsyncRequest {
+    std::promise<NotionResponse> promise;
+    // Set when the future was dropped
+    shared_ptr<std::atomic<bool>> cancelled;
+    NotionRateLimiter *limiter;
+    std::string url;
+    std::string method;
+    std::string host;
+    bool secure;
+    std::string request;
+    bool idempotent;
+    idx_t attempt = 0;
+    idx_t retries;
+    std::chrono::steady_clock::time_point request_start;
+    // The retry backoff: the attempt is not sent before this point in time
+    std::chrono::steady_clock::time_point not_before;
+};
+
+static void SendAttempt(shared_ptr<NotionAsyncRequest> request);
+
+static void OnResponse(shared_ptr<NotionAsyncRequest> request, NotionResponse response, bool delivered) {
+    auto &stats = NotionStats::Get();
+    if (*request->cancelled) {
+        // Nobody waits for the response; an attempt that was not sent gives back its token
+        if (!delivered) {
+            request->limiter->Release();
+        }
+        request->promise.set_value(std::move(response));
+        return;
+    }
+    if (!response.success && request->attempt < request->retries) {
+        if (response.status_code == 429) {
+            // Rejected before processing: always safe to retry. Hold back every request made
+            // with this token, not just this one, until the server is ready again.
+            double delay = response.retry_after > 0 ? response.retry_after : BackoffDelay(request->attempt);
+            request->limiter->Pause(delay);
+            request->attempt++;
+            SendAttempt(std::move(request));
+            return;
+        }
+        bool transient = response.status_code == 0 || IsRetryableStatus(response.status_code);
+        // A request that reached the server may have been applied even though it failed
+        if (transient && (request->idempotent || !delivered)) {
+            auto delay = BackoffDelay(request->attempt);
+            stats.Record(NotionStatPhase::RETRY_BACKOFF, static_cast<uint64_t>(delay * 1000000));
+            request->not_before = std::chrono::steady_clock::now() +
+                                  std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                      std::chrono::duration<double>(delay));
+            request->attempt++;
+            SendAttempt(std::move(request));
+            return;
+        }
+    }
+    stats.RecordRequest(request->method, request->url, response.status_code, request->attempt,
+                        NotionStats::ElapsedMicros(request->request_start), response.body.size());
+    request->promise.set_value(std::move(response));
+}
+
+static void SendAttempt(shared_ptr<NotionAsyncRequest> request) {
+    auto ready_at = std::max(std::chrono::steady_clock::now(), request->not_before);
+    auto send_at = std::max(ready_at, request->limiter->Reserve());
+    // The event loop waits instead of the caller; the wait is recorded as it would have been blocked
+    NotionStats::Get().Record(NotionStatPhase::RATE_LIMIT_WAIT,
+                              std::chrono::duration_cast<std::chrono::microseconds>(send_at - ready_at).count());
+    auto &transport = NotionTransport::Get();
+    transport.Send(request->host, request->secure, request->request, send_at, request->cancelled,
+                   [request](NotionResponse response, bool delivered) {
+                       OnResponse(request, std::move(response), delivered);
+                   });
+}
+
+NotionRequestFuture::NotionRequestFuture(std::future<NotionResponse> response_p,
+                                         shared_ptr<std::atomic<bool>> cancelled_p)
+    : response(std::move(response_p)), cancelled(std::move(cancelled_p)) {
+}
+
+NotionRequestFuture &NotionRequestFuture::operator=(NotionRequestFuture &&other) noexcept {
+    if (this != &other) {
+        Cancel();
+        response = std::move(other.response);
+        cancelled = std::move(other.cancelled);
+    }
+    return *this;
+}
+
+NotionRequestFuture::~NotionRequestFuture() {
+    Cancel();
+}
+
+NotionResponse NotionRequestFuture::Get() {
+    return response.get();
+}
+
+void NotionRequestFuture::Cancel() {
+    if (!response.valid() || !cancelled || cancelled->exchange(true)) {
+        return;
+    }
+    // Requests waiting on an event loop for their send time are dropped right away
+    NotionTransport::Get().Sweep();
+    response = std::future<NotionResponse>();
+}
+
+NotionRequestFuture NotionRequests::MakeRequestAsync(const std::string &url,
+                                                     const std::string &auth_token,
+                                                     const std::string &method,
+                                                     const std::string &body,
+                                                     bool idempotent) {
+    auto cancelled = make_shared_ptr<std::atomic<bool>>(false);
+    if (!NotionTransport::Get().Enabled()) {
+        // Without the event loop the request blocks a thread of its own
+        auto promise = make_shared_ptr<std::promise<NotionResponse>>();
+        auto result = promise->get_future();
+        std::thread([promise, cancelled, url, auth_token, method, body, idempotent]() {
+            try {
+                promise->set_value(MakeBlockingRequest(url, auth_token, method, body, idempotent, cancelled.get()));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        }).detach();
+        return NotionRequestFuture(std::move(result), std::move(cancelled));
+    }
+
+    auto request = make_shared_ptr<NotionAsyncRequest>();
+    NotionRequestFuture result(request->promise.get_future(), cancelled);
+    request->cancelled = std::move(cancelled);
+    if (!BuildRequest(url, auth_token, method, body, request->host, request->secure, request->request)) {
+        NotionResponse response;
+        response.success = false;
+        response.status_code = 0;
+        response.body = "Invalid Notion API URL: " + url;
+        request->promise.set_value(std::move(response));
+        return result;
+    }
+    request->limiter = &NotionRateLimiter::ForToken(auth_token);
+    request->url = url;
+    request->method = method;
+    request->idempotent = idempotent;
+    request->retries = max_retries;
+    request->request_start = std::chrono::steady_clock::now();
+    request->not_before = request->request_start;
+    SendAttempt(std::move(request));
+    return result;
+}
+
+NotionResponse NotionRequests::MakeRequest(const std::string &url,
+                                           const std::string &auth_token,
+                                           const std::string &method,
+                                           const std::string &body,
+                                           bool idempotent) {
+    if (NotionTransport::Get().Enabled()) {
+        return MakeRequestAsync(url, auth_token, method, body, idempotent).Get();
+    }
+    return MakeBlockingRequest(url, auth_token, method, body, idempotent);
+}
+
+// Percent-encodes a query parameter value. Property ids are already percent-encoded by
+// Notion, so existing escapes are kept as they are.
+static std::string EncodeQueryValue(const std::string &value) {
+    static const char *HEX_DIGITS = "0123456789ABCDEF";
+    std::string result;
+    for (unsigned char c : value) {
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~' || c == '%') {
+            result += static_cast<char>(c);
+        } else {
+            result += '%';
+            result += HEX_DIGITS[c >> 4];
+            result += HEX_DIGITS[c & 0xF];
+        }
+    }
+    return result;
+}
+
+static std::string QueryDatabaseUrl(const std::string &database_id, const NotionQueryOptions &options) {
+    std::string url = NotionRequests::GetBaseUrl() + "/databases/" + database_id + "/query";
+    for (idx_t i = 0; i < options.filter_properties.size(); i++) {
+        url += i == 0 ? "?" : "&";
+        url += "filter_properties=" + EncodeQueryValue(options.filter_properties[i]);
+    }
+    return url;
+}
 
+static std::string QueryDatabaseBody(const std::string &start_cursor, const std::string &data_source_id,
+                                     const NotionQueryOptions &options) {
     std::stringstream body;
     body << "{";
 
@@ -139,25 +479,109 @@ NotionResponse NotionRequests::QueryDatabase(const std::string &database_id,
     if (!data_source_id.empty()) {
         if (has_params) body << ",";
         body << "\"data_source_id\":\"" << data_source_id << "\"";
+        has_params = true;
+    }
+
+    if (!options.filter.empty()) {
+        if (has_params) body << ",";
+        body << "\"filter\":" << options.filter;
+        has_params = true;
+    }
+
+    if (!options.sorts.empty()) {
+        if (has_params) body << ",";
+        body << "\"sorts\":" << options.sorts;
+        has_params = true;
+    }
+
+    if (options.page_size > 0) {
+        if (has_params) body << ",";
+        body << "\"page_size\":" << options.page_size;
     }
 
     body << "}";
+    return body.str();
+}
 
-    return MakeRequest(url, auth_token, "POST", body.str());
+NotionResponse NotionRequests::QueryDatabase(const std::string &database_id,
+                                             const std::string &auth_token,
+                                             const std::string &start_cursor,
+                                             const std::string &data_source_id,
+                                             const NotionQueryOptions &options) {
+    return MakeRequest(QueryDatabaseUrl(database_id, options), auth_token, "POST",
+                       QueryDatabaseBody(start_cursor, data_source_id, options));
+}
+
+NotionRequestFuture NotionRequests::QueryDatabaseAsync(const std::string &database_id,
+                                                       const std::string &auth_token,
+                                                       const std::string &start_cursor,
+                                                       const std::string &data_source_id,
+                                                       const NotionQueryOptions &options) {
+    return MakeRequestAsync(QueryDatabaseUrl(database_id, options), auth_token, "POST",
+                            QueryDatabaseBody(start_cursor, data_source_id, options));
 }
 
 NotionResponse NotionRequests::GetDatabase(const std::string &database_id,
                                           const std::string &auth_token) {
-    std::string url = NOTION_API_BASE + "/databases/" + database_id;
+    std::string url = GetBaseUrl() + "/databases/" + database_id;
     return MakeRequest(url, auth_token, "GET");
 }
 
-NotionResponse NotionRequests::CreatePage(const std::string &database_id,
-                                         const std::string &auth_token,
-                                         const std::string &properties,
-                                         const std::string &data_source_id) {
-    std::string url = NOTION_API_BASE + "/pages";
+NotionRequestFuture NotionRequests::GetDatabaseAsync(const std::string &database_id,
+                                                     const std::string &auth_token) {
+    return MakeRequestAsync(GetBaseUrl() + "/databases/" + database_id, auth_token, "GET");
+}
 
+static std::string GetPageUrl(const std::string &page_id, const vector<std::string> &properties) {
+    std::string url = NotionRequests::GetBaseUrl() + "/pages/" + page_id;
+    for (idx_t i = 0; i < properties.size(); i++) {
+        url += i == 0 ? "?" : "&";
+        url += "filter_properties=" + EncodeQueryValue(properties[i]);
+    }
+    return url;
+}
+
+NotionResponse NotionRequests::GetPage(const std::string &page_id,
+                                      const std::string &auth_token,
+                                      const vector<std::string> &properties) {
+    return MakeRequest(GetPageUrl(page_id, properties), auth_token, "GET");
+}
+
+NotionRequestFuture NotionRequests::GetPageAsync(const std::string &page_id,
+                                                 const std::string &auth_token,
+                                                 const vector<std::string> &properties) {
+    return MakeRequestAsync(GetPageUrl(page_id, properties), auth_token, "GET");
+}
+
+NotionResponse NotionRequests::Search(const std::string &auth_token,
+                                     const std::string &object_type,
+                                     const std::string &start_cursor) {
+    std::string url = GetBaseUrl() + "/search";
+
+    std::string body = "{\"filter\":{\"property\":\"object\",\"value\":";
+    NotionUtils::AppendJsonString(body, object_type);
+    body += "},\"page_size\":100";
+    if (!start_cursor.empty()) {
+        body += ",\"start_cursor\":";
+        NotionUtils::AppendJsonString(body, start_cursor);
+    }
+    body += "}";
+
+    return MakeRequest(url, auth_token, "POST", body);
+}
+
+NotionResponse NotionRequests::GetBlockChildren(const std::string &block_id,
+                                               const std::string &auth_token,
+                                               const std::string &start_cursor) {
+    std::string url = GetBaseUrl() + "/blocks/" + block_id + "/children?page_size=100";
+    if (!start_cursor.empty()) {
+        url += "&start_cursor=" + EncodeQueryValue(start_cursor);
+    }
+    return MakeRequest(url, auth_token, "GET");
+}
+
+static std::string CreatePageBody(const std::string &database_id, const std::string &properties,
+                                  const std::string &data_source_id) {
     std::stringstream body;
     body << "{\"parent\":{\"database_id\":\"" << database_id << "\"";
 
@@ -166,24 +590,43 @@ NotionResponse NotionRequests::CreatePage(const std::string &database_id,
     }
 
     body << "},\"properties\":" << properties << "}";
+    return body.str();
+}
 
-    return MakeRequest(url, auth_token, "POST", body.str());
+NotionResponse NotionRequests::CreatePage(const std::string &database_id,
+                                         const std::string &auth_token,
+                                         const std::string &properties,
+                                         const std::string &data_source_id) {
+    // Retrying a page creation that reached Notion could create the page twice
+    return MakeRequest(GetBaseUrl() + "/pages", auth_token, "POST",
+                       CreatePageBody(database_id, properties, data_source_id), false);
+}
+
+NotionRequestFuture NotionRequests::CreatePageAsync(const std::string &database_id,
+                                                    const std::string &auth_token,
+                                                    const std::string &properties,
+                                                    const std::string &data_source_id) {
+    return MakeRequestAsync(GetBaseUrl() + "/pages", auth_token, "POST",
+                            CreatePageBody(database_id, properties, data_source_id), false);
 }
 
 NotionResponse NotionRequests::UpdatePage(const std::string &page_id,
                                          const std::string &auth_token,
                                          const std::string &properties) {
-    std::string url = NOTION_API_BASE + "/pages/" + page_id;
-
-    std::stringstream body;
-    body << "{\"properties\":" << properties << "}";
+    return MakeRequest(GetBaseUrl() + "/pages/" + page_id, auth_token, "PATCH",
+                       "{\"properties\":" + properties + "}");
+}
 
-    return MakeRequest(url, auth_token, "PATCH", body.str());
+NotionRequestFuture NotionRequests::UpdatePageAsync(const std::string &page_id,
+                                                    const std::string &auth_token,
+                                                    const std::string &properties) {
+    return MakeRequestAsync(GetBaseUrl() + "/pages/" + page_id, auth_token, "PATCH",
+                            "{\"properties\":" + properties + "}");
 }
 
 NotionResponse NotionRequests::GetDataSource(const std::string &database_id,
                                             const std::string &auth_token) {
-    std::string url = NOTION_API_BASE + "/data_sources?database_id=" + database_id;
+    std::string url = GetBaseUrl() + "/data_sources?database_id=" + database_id;
     return MakeRequest(url, auth_token, "GET");
 }
 
@@ -0,0 +1,204 @@
+#include "notion_schema.hpp"
+#include "notion_json.hpp"
+#include "duckdb/common/exception.hpp"
+#include <unordered_set>
+
+namespace duckdb {
+
+// Reads the name of an option object
+static bool ReadOptionName(NotionJsonCursor &cursor, NotionJsonString &name) {
+    if (!cursor.EnterObject()) {
+        return false;
+    }
+    bool found = false;
+    NotionJsonString key;
+    while (cursor.NextKey(key)) {
+        if (key.Equals("name")) {
+            found = cursor.ReadString(name);
+        } else {
+            cursor.SkipValue();
+        }
+    }
+    return found;
+}
+
+// Reads {"options": [{"id": "...", "name": "Done", "color": "green"}, ...], ...}
+static void ParseOptions(NotionJsonCursor &cursor, vector<std::string> &options) {
+    if (!cursor.EnterObject()) {
+        return;
+    }
+    NotionJsonString key;
+    while (cursor.NextKey(key)) {
+        if (!key.Equals("options")) {
+            cursor.SkipValue();
+            continue;
+        }
+        if (!cursor.EnterArray()) {
+            continue;
+        }
+        while (cursor.NextElement()) {
+            NotionJsonString name;
+            if (ReadOptionName(cursor, name)) {
+                options.push_back(name.ToString());
+            }
+        }
+    }
+}
+
+vector<NotionProperty> NotionSchema::ParseProperties(const std::string &json) {
+    vector<NotionProperty> properties;
+
+    NotionJsonCursor cursor(json);
+    if (!cursor.EnterObject() || !cursor.FindKey("properties") || !cursor.EnterObject()) {
+        return properties;
+    }
+
+    // "properties": {"<name>": {"id": "...", "name": "...", "type": "number", "number": {...}}, ...}
+    NotionJsonString property_name;
+    while (cursor.NextKey(property_name)) {
+        NotionProperty property;
+        property.name = property_name.ToString();
+        property.type = NotionPropertyType::OTHER;
+
+        if (!cursor.EnterObject()) {
+            continue;
+        }
+        NotionJsonString key;
+        while (cursor.NextKey(key)) {
+            NotionJsonString text;
+            if (key.Equals("id")) {
+                if (cursor.ReadString(text)) {
+                    property.id = text.ToString();
+                }
+            } else if (key.Equals("type")) {
+                if (cursor.ReadString(text)) {
+                    property.type = GetPropertyType(text.ToString());
+                }
+            } else if (key.Equals("select") || key.Equals("status") || key.Equals("multi_select")) {
+                ParseOptions(cursor, property.options);
+            } else {
+                cursor.SkipValue();
+            }
+        }
+        properties.push_back(std::move(property));
+    }
+
+    if (cursor.HasError()) {
+        throw IOException("Failed to parse Notion database schema");
+    }
+    return properties;
+}
+
+NotionPropertyType NotionSchema::GetPropertyType(const std::string &type_name) {
+    static const std::unordered_map<std::string, NotionPropertyType> property_types = {
+        {"title", NotionPropertyType::TITLE},
+        {"rich_text", NotionPropertyType::RICH_TEXT},
+        {"number", NotionPropertyType::NUMBER},
+        {"checkbox", NotionPropertyType::CHECKBOX},
+        {"select", NotionPropertyType::SELECT},
+        {"status", NotionPropertyType::STATUS},
+        {"multi_select", NotionPropertyType::MULTI_SELECT},
+        {"date", NotionPropertyType::DATE},
+        {"url", NotionPropertyType::URL},
+        {"email", NotionPropertyType::EMAIL},
+        {"phone_number", NotionPropertyType::PHONE_NUMBER},
+        {"created_time", NotionPropertyType::CREATED_TIME},
+        {"last_edited_time", NotionPropertyType::LAST_EDITED_TIME},
+        {"created_by", NotionPropertyType::CREATED_BY},
+        {"last_edited_by", NotionPropertyType::LAST_EDITED_BY},
+        {"people", NotionPropertyType::PEOPLE},
+        {"relation", NotionPropertyType::RELATION},
+        {"unique_id", NotionPropertyType::UNIQUE_ID},
+        {"formula", NotionPropertyType::FORMULA},
+    };
+
+    auto entry = property_types.find(type_name);
+    if (entry == property_types.end()) {
+        return NotionPropertyType::OTHER;
+    }
+    return entry->second;
+}
+
+LogicalType NotionSchema::GetLogicalType(NotionPropertyType type) {
+    switch (type) {
+    case NotionPropertyType::NUMBER:
+        return LogicalType::DOUBLE;
+    case NotionPropertyType::CHECKBOX:
+        return LogicalType::BOOLEAN;
+    case NotionPropertyType::DATE:
+    case NotionPropertyType::CREATED_TIME:
+    case NotionPropertyType::LAST_EDITED_TIME:
+        return LogicalType::TIMESTAMP;
+    case NotionPropertyType::MULTI_SELECT:
+    case NotionPropertyType::PEOPLE:
+    case NotionPropertyType::RELATION:
+        return LogicalType::LIST(LogicalType::VARCHAR);
+    default:
+        // Text-like properties, plus formulas and unsupported types rendered as text
+        return LogicalType::VARCHAR;
+    }
+}
+
+LogicalType NotionSchema::GetLogicalType(const NotionProperty &property) {
+    if (property.options.empty()) {
+        return GetLogicalType(property.type);
+    }
+    switch (property.type) {
+    case NotionPropertyType::SELECT:
+    case NotionPropertyType::STATUS:
+        return GetEnumType(property.options);
+    case NotionPropertyType::MULTI_SELECT:
+        return LogicalType::LIST(GetEnumType(property.options));
+    default:
+        return GetLogicalType(property.type);
+    }
+}
+
+LogicalType NotionSchema::GetEnumType(const vector<std::string> &options) {
+    // Option names are unique within a property, but an ENUM rejects duplicates outright
+    std::unordered_set<std::string> seen;
+    vector<std::string> labels;
+    for (const auto &option : options) {
+        if (seen.insert(option).second) {
+            labels.push_back(option);
+        }
+    }
+    Vector values(LogicalType::VARCHAR, labels.size());
+    auto data = FlatVector::GetData<string_t>(values);
+    for (idx_t i = 0; i < labels.size(); i++) {
+        data[i] = StringVector::AddString(values, labels[i]);
+    }
+    return LogicalType::ENUM(values, labels.size());
+}
+
+void NotionSchema::UseTextTypes(vector<NotionColumn> &columns) {
+    for (auto &column : columns) {
+        column.logical_type = GetLogicalType(column.type);
+    }
+}
+
+vector<NotionColumn> NotionSchema::GetColumns(const vector<NotionProperty> &properties) {
+    vector<NotionColumn> columns;
+
+    // Page-level fields are added unless a property already uses the name
+    auto add_page_field = [&](const std::string &name, NotionPropertyType type) {
+        for (const auto &property : properties) {
+            if (property.name == name) {
+                return;
+            }
+        }
+        columns.push_back({name, name, "", false, type, GetLogicalType(type)});
+    };
+
+    add_page_field("id", NotionPropertyType::PAGE_ID);
+    for (const auto &property : properties) {
+        columns.push_back(
+            {property.name, property.name, property.id, true, property.type, GetLogicalType(property)});
+    }
+    add_page_field("created_time", NotionPropertyType::CREATED_TIME);
+    add_page_field("last_edited_time", NotionPropertyType::LAST_EDITED_TIME);
+
+    return columns;
+}
+
+} // namespace duckdb
@@ -0,0 +1,204 @@
+#include "notion_schema_cache.hpp"
+#include "notion_utils.hpp"
+#include "duckdb/main/extension_util.hpp"
+
+namespace duckdb {
+
+NotionSchemaCache &NotionSchemaCache::Get(ClientContext &context) {
+    auto &object_cache = ObjectCache::GetObjectCache(context);
+    return *object_cache.GetOrCreate<NotionSchemaCache>(ObjectType());
+}
+
+std::chrono::seconds NotionSchemaCache::GetTTL(ClientContext &context) {
+    Value ttl;
+    if (context.TryGetCurrentSetting("notion_schema_cache_ttl", ttl) && !ttl.IsNull()) {
+        return std::chrono::seconds(ttl.GetValue<uint64_t>());
+    }
+    return std::chrono::seconds(NotionSchemaCache::DEFAULT_TTL_SECONDS);
+}
+
+idx_t NotionSchemaCache::BeginLookup(std::chrono::seconds ttl, const std::string &key, const std::string &database_id,
+                                     std::promise<NotionResponse> &promise,
+                                     std::shared_future<NotionResponse> &response) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto now = std::chrono::steady_clock::now();
+    auto entry = entries.find(key);
+    if (entry != entries.end()) {
+        // An entry without a result yet is a lookup in flight, which is always joined
+        bool in_flight = entry->second.response.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+        if (in_flight || now - entry->second.fetched_at < ttl) {
+            response = entry->second.response;
+            return 0;
+        }
+    }
+    response = promise.get_future().share();
+    auto lookup_id = ++last_lookup_id;
+    entries[key] = {database_id, lookup_id, response, now};
+    return lookup_id;
+}
+
+NotionResponse NotionSchemaCache::FinishLookup(const std::string &key, idx_t lookup_id,
+                                               std::promise<NotionResponse> &promise,
+                                               const std::function<NotionResponse()> &fetch) {
+    NotionResponse result;
+    try {
+        result = fetch();
+    } catch (...) {
+        // Waiting callers see the same error, e.g. an interrupt, and the entry is not cached
+        std::lock_guard<std::mutex> guard(lock);
+        promise.set_exception(std::current_exception());
+        auto entry = entries.find(key);
+        if (entry != entries.end() && entry->second.lookup_id == lookup_id) {
+            entries.erase(entry);
+        }
+        throw;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    promise.set_value(result);
+    auto entry = entries.find(key);
+    if (entry != entries.end() && entry->second.lookup_id == lookup_id) {
+        if (result.success) {
+            entry->second.fetched_at = std::chrono::steady_clock::now();
+        } else {
+            // Failures are handed to the waiting callers but not cached
+            entries.erase(entry);
+        }
+    }
+    return result;
+}
+
+NotionResponse NotionSchemaCache::Lookup(std::chrono::seconds ttl, const std::string &key,
+                                         const std::string &database_id,
+                                         const std::function<NotionResponse()> &fetch) {
+    std::promise<NotionResponse> promise;
+    std::shared_future<NotionResponse> response;
+    auto lookup_id = BeginLookup(ttl, key, database_id, promise, response);
+    if (lookup_id == 0) {
+        return response.get();
+    }
+    // This caller owns the lookup; others wait for its result
+    return FinishLookup(key, lookup_id, promise, fetch);
+}
+
+NotionResponse NotionSchemaCache::GetDatabase(ClientContext &context, const std::string &database_id,
+                                              const std::string &auth_token) {
+    // Integrations may see different databases, so entries are kept per token
+    return Lookup(GetTTL(context), "database/" + database_id + "/" + auth_token, database_id,
+                  [&]() { return NotionRequests::GetDatabase(database_id, auth_token); });
+}
+
+vector<NotionResponse> NotionSchemaCache::GetDatabases(ClientContext &context, const vector<std::string> &database_ids,
+                                                       const std::string &auth_token) {
+    struct DatabaseLookup {
+        std::string key;
+        idx_t lookup_id;
+        std::promise<NotionResponse> promise;
+        std::shared_future<NotionResponse> response;
+        NotionRequestFuture request;
+    };
+
+    // The uncached databases are requested at once through the async request path, so a scan of
+    // many databases costs in-flight requests rather than threads
+    auto ttl = GetTTL(context);
+    vector<DatabaseLookup> lookups(database_ids.size());
+    for (idx_t i = 0; i < database_ids.size(); i++) {
+        auto &lookup = lookups[i];
+        lookup.key = "database/" + database_ids[i] + "/" + auth_token;
+        lookup.lookup_id = BeginLookup(ttl, lookup.key, database_ids[i], lookup.promise, lookup.response);
+        if (lookup.lookup_id != 0) {
+            lookup.request = NotionRequests::GetDatabaseAsync(database_ids[i], auth_token);
+        }
+    }
+
+    // Every owned lookup is finished, even after an error, so no other caller waits on it forever
+    vector<NotionResponse> responses;
+    std::exception_ptr error;
+    for (auto &lookup : lookups) {
+        try {
+            if (lookup.lookup_id == 0) {
+                responses.push_back(lookup.response.get());
+            } else {
+                responses.push_back(
+                    FinishLookup(lookup.key, lookup.lookup_id, lookup.promise, [&]() { return lookup.request.Get(); }));
+            }
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return responses;
+}
+
+NotionResponse NotionSchemaCache::GetDataSource(ClientContext &context, const std::string &database_id,
+                                                const std::string &auth_token) {
+    return Lookup(GetTTL(context), "data_source/" + database_id + "/" + auth_token, database_id,
+                  [&]() { return NotionRequests::GetDataSource(database_id, auth_token); });
+}
+
+idx_t NotionSchemaCache::Invalidate(const std::string &database_id) {
+    std::lock_guard<std::mutex> guard(lock);
+    idx_t removed = 0;
+    for (auto entry = entries.begin(); entry != entries.end();) {
+        if (database_id.empty() || entry->second.database_id == database_id) {
+            entry = entries.erase(entry);
+            removed++;
+        } else {
+            entry++;
+        }
+    }
+    return removed;
+}
+
+struct NotionSchemaCacheClearData : public TableFunctionData {
+    std::string database_id;
+};
+
+struct NotionSchemaCacheClearState : public GlobalTableFunctionState {
+    bool done = false;
+};
+
+static unique_ptr<FunctionData> NotionSchemaCacheClearBind(ClientContext &context, TableFunctionBindInput &input,
+                                                           vector<LogicalType> &return_types, vector<string> &names) {
+    auto bind_data = make_uniq<NotionSchemaCacheClearData>();
+    if (!input.inputs.empty() && !input.inputs[0].IsNull()) {
+        bind_data->database_id = NotionUtils::ExtractDatabaseId(input.inputs[0].ToString());
+    }
+    names.push_back("entries_removed");
+    return_types.push_back(LogicalType::BIGINT);
+    return std::move(bind_data);
+}
+
+static unique_ptr<GlobalTableFunctionState> NotionSchemaCacheClearInit(ClientContext &context,
+                                                                       TableFunctionInitInput &input) {
+    return make_uniq<NotionSchemaCacheClearState>();
+}
+
+static void NotionSchemaCacheClearFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &bind_data = data_p.bind_data->Cast<NotionSchemaCacheClearData>();
+    auto &state = data_p.global_state->Cast<NotionSchemaCacheClearState>();
+    if (state.done) {
+        return;
+    }
+    state.done = true;
+
+    auto removed = NotionSchemaCache::Get(context).Invalidate(bind_data.database_id);
+    output.SetValue(0, 0, Value::BIGINT(removed));
+    output.SetCardinality(1);
+}
+
+void NotionSchemaCache::RegisterFunctions(DatabaseInstance &db) {
+    // notion_schema_cache_clear() drops all entries, notion_schema_cache_clear(database) those of one database
+    TableFunctionSet cache_clear("notion_schema_cache_clear");
+    cache_clear.AddFunction(TableFunction({}, NotionSchemaCacheClearFunction, NotionSchemaCacheClearBind,
+                                          NotionSchemaCacheClearInit));
+    cache_clear.AddFunction(TableFunction({LogicalType::VARCHAR}, NotionSchemaCacheClearFunction,
+                                          NotionSchemaCacheClearBind, NotionSchemaCacheClearInit));
+    ExtensionUtil::RegisterFunction(db, cache_clear);
+}
+
+} // namespace duckdb
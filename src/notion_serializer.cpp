@@ -0,0 +1,265 @@
+#include "notion_serializer.hpp"
+#include "notion_utils.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/types/date.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include <cmath>
+#include <cstdio>
+
+namespace duckdb {
+
+// Name of the type's member in a property value, or nullptr when it cannot be written
+static const char *WritableTypeName(NotionPropertyType type) {
+    switch (type) {
+    case NotionPropertyType::TITLE:
+        return "title";
+    case NotionPropertyType::RICH_TEXT:
+        return "rich_text";
+    case NotionPropertyType::NUMBER:
+        return "number";
+    case NotionPropertyType::CHECKBOX:
+        return "checkbox";
+    case NotionPropertyType::SELECT:
+        return "select";
+    case NotionPropertyType::STATUS:
+        return "status";
+    case NotionPropertyType::MULTI_SELECT:
+        return "multi_select";
+    case NotionPropertyType::DATE:
+        return "date";
+    case NotionPropertyType::URL:
+        return "url";
+    case NotionPropertyType::EMAIL:
+        return "email";
+    case NotionPropertyType::PHONE_NUMBER:
+        return "phone_number";
+    case NotionPropertyType::PEOPLE:
+        return "people";
+    case NotionPropertyType::RELATION:
+        return "relation";
+    default:
+        return nullptr;
+    }
+}
+
+static LogicalType GetValueType(NotionPropertyType type, const LogicalType &column_type) {
+    switch (type) {
+    case NotionPropertyType::NUMBER:
+        return LogicalType::DOUBLE;
+    case NotionPropertyType::CHECKBOX:
+        return LogicalType::BOOLEAN;
+    case NotionPropertyType::DATE:
+        // Dates without a time are written as dates, everything else as a UTC timestamp
+        return column_type.id() == LogicalTypeId::DATE ? LogicalType::DATE : LogicalType::TIMESTAMP;
+    case NotionPropertyType::MULTI_SELECT:
+    case NotionPropertyType::PEOPLE:
+    case NotionPropertyType::RELATION:
+        return LogicalType::LIST(LogicalType::VARCHAR);
+    default:
+        return LogicalType::VARCHAR;
+    }
+}
+
+vector<NotionPropertyWriter> NotionPropertySerializer::Bind(const vector<LogicalType> &column_types,
+                                                            const vector<NotionColumn> &target_columns,
+                                                            const vector<idx_t> &target_column_ids) {
+    vector<NotionPropertyWriter> writers;
+    for (idx_t col_idx = 0; col_idx < column_types.size(); col_idx++) {
+        const auto *target = &target_columns[target_column_ids[col_idx]];
+        auto type_name = WritableTypeName(target->type);
+        if (!target->is_property || !type_name) {
+            continue;
+        }
+
+        NotionPropertyWriter writer;
+        writer.column_idx = col_idx;
+        writer.type = target->type;
+        NotionUtils::AppendJsonString(writer.prefix, target->key);
+        writer.prefix += ":{\"";
+        writer.prefix += type_name;
+        writer.prefix += "\":";
+        writer.value_type = GetValueType(target->type, column_types[col_idx]);
+        writers.push_back(std::move(writer));
+    }
+    return writers;
+}
+
+NotionPropertySerializer::NotionPropertySerializer(ClientContext &context_p,
+                                                   const vector<NotionPropertyWriter> &writers_p)
+    : context(context_p), writers(writers_p), cast_vectors(writers_p.size()), formats(writers_p.size()),
+      child_formats(writers_p.size()) {
+}
+
+void NotionPropertySerializer::SetChunk(DataChunk &input) {
+    for (idx_t i = 0; i < writers.size(); i++) {
+        const auto &writer = writers[i];
+        auto &source = input.data[writer.column_idx];
+        Vector *values = &source;
+        if (source.GetType() != writer.value_type) {
+            // A fresh vector per chunk, so cast strings do not pile up in its heap
+            cast_vectors[i] = make_uniq<Vector>(writer.value_type);
+            VectorOperations::Cast(context, source, *cast_vectors[i], input.size());
+            values = cast_vectors[i].get();
+        }
+        values->ToUnifiedFormat(input.size(), formats[i]);
+        if (writer.value_type.id() == LogicalTypeId::LIST) {
+            auto &child = ListVector::GetEntry(*values);
+            child.ToUnifiedFormat(ListVector::GetListSize(*values), child_formats[i]);
+        }
+    }
+}
+
+// Writes text as an array of text objects, splitting it at UTF-8 character boundaries
+// into pieces Notion accepts
+void NotionPropertySerializer::WriteText(const string_t &text, std::string &result) {
+    auto data = text.GetData();
+    idx_t size = text.GetSize();
+    result += "[";
+    idx_t offset = 0;
+    while (offset < size) {
+        idx_t length = MinValue(size - offset, MAX_TEXT_LENGTH);
+        while (offset + length < size && (static_cast<unsigned char>(data[offset + length]) & 0xC0) == 0x80) {
+            length--;
+        }
+        if (offset > 0) {
+            result += ",";
+        }
+        result += "{\"text\":{\"content\":";
+        NotionUtils::AppendJsonString(result, data + offset, length);
+        result += "}}";
+        offset += length;
+    }
+    result += "]";
+}
+
+void NotionPropertySerializer::WriteValue(idx_t writer_idx, idx_t row, std::string &result) {
+    const auto &writer = writers[writer_idx];
+    const auto &format = formats[writer_idx];
+    auto index = format.sel->get_index(row);
+    bool valid = format.validity.RowIsValid(index);
+
+    switch (writer.type) {
+    case NotionPropertyType::TITLE:
+    case NotionPropertyType::RICH_TEXT:
+        if (!valid) {
+            result += "[]";
+            break;
+        }
+        WriteText(UnifiedVectorFormat::GetData<string_t>(format)[index], result);
+        break;
+    case NotionPropertyType::NUMBER: {
+        double number = valid ? UnifiedVectorFormat::GetData<double>(format)[index] : 0;
+        if (!valid || !std::isfinite(number)) {
+            result += "null";
+            break;
+        }
+        // Shortest of the usual precisions that round-trips
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.15g", number);
+        if (strtod(buffer, nullptr) != number) {
+            snprintf(buffer, sizeof(buffer), "%.17g", number);
+        }
+        result += buffer;
+        break;
+    }
+    case NotionPropertyType::CHECKBOX:
+        result += valid && UnifiedVectorFormat::GetData<bool>(format)[index] ? "true" : "false";
+        break;
+    case NotionPropertyType::SELECT:
+    case NotionPropertyType::STATUS: {
+        if (!valid) {
+            result += "null";
+            break;
+        }
+        auto name = UnifiedVectorFormat::GetData<string_t>(format)[index];
+        result += "{\"name\":";
+        NotionUtils::AppendJsonString(result, name.GetData(), name.GetSize());
+        result += "}";
+        break;
+    }
+    case NotionPropertyType::DATE: {
+        if (!valid) {
+            result += "null";
+            break;
+        }
+        result += "{\"start\":\"";
+        if (writer.value_type.id() == LogicalTypeId::DATE) {
+            result += Date::ToString(UnifiedVectorFormat::GetData<date_t>(format)[index]);
+        } else {
+            result += NotionUtils::ToIsoTimestamp(UnifiedVectorFormat::GetData<timestamp_t>(format)[index]);
+        }
+        result += "\"}";
+        break;
+    }
+    case NotionPropertyType::MULTI_SELECT:
+    case NotionPropertyType::PEOPLE:
+    case NotionPropertyType::RELATION: {
+        result += "[";
+        if (valid) {
+            // Options are referenced by name, pages and people by id
+            const char *member = writer.type == NotionPropertyType::MULTI_SELECT ? "{\"name\":" : "{\"id\":";
+            auto entry = UnifiedVectorFormat::GetData<list_entry_t>(format)[index];
+            const auto &child_format = child_formats[writer_idx];
+            auto children = UnifiedVectorFormat::GetData<string_t>(child_format);
+            bool first = true;
+            for (idx_t i = entry.offset; i < entry.offset + entry.length; i++) {
+                auto child_index = child_format.sel->get_index(i);
+                if (!child_format.validity.RowIsValid(child_index)) {
+                    continue;
+                }
+                if (!first) {
+                    result += ",";
+                }
+                first = false;
+                result += member;
+                NotionUtils::AppendJsonString(result, children[child_index].GetData(), children[child_index].GetSize());
+                result += "}";
+            }
+        }
+        result += "]";
+        break;
+    }
+    default: {
+        // URL, email and phone number are plain strings
+        if (!valid) {
+            result += "null";
+            break;
+        }
+        auto text = UnifiedVectorFormat::GetData<string_t>(format)[index];
+        NotionUtils::AppendJsonString(result, text.GetData(), text.GetSize());
+        break;
+    }
+    }
+}
+
+bool NotionPropertySerializer::SerializeValue(idx_t writer_idx, idx_t row, std::string &result) {
+    if (writers[writer_idx].type == NotionPropertyType::STATUS &&
+        !formats[writer_idx].validity.RowIsValid(formats[writer_idx].sel->get_index(row))) {
+        // A status cannot be cleared, so a NULL status leaves the property alone
+        return false;
+    }
+    WriteValue(writer_idx, row, result);
+    return true;
+}
+
+void NotionPropertySerializer::Serialize(idx_t row, std::string &result) {
+    result += "{";
+    bool first = true;
+    for (idx_t i = 0; i < writers.size(); i++) {
+        auto property_start = result.size();
+        if (!first) {
+            result += ",";
+        }
+        result += writers[i].prefix;
+        if (!SerializeValue(i, row, result)) {
+            result.resize(property_start);
+            continue;
+        }
+        first = false;
+        result += "}";
+    }
+    result += "}";
+}
+
+} // namespace duckdb
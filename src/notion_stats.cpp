@@ -0,0 +1,264 @@
+#include "notion_stats.hpp"
+#include "duckdb/main/extension_util.hpp"
+
+namespace duckdb {
+
+static idx_t BucketIndex(uint64_t micros) {
+    idx_t bucket = 0;
+    while (micros > 1 && bucket + 1 < NotionLatencyHistogram::BUCKET_COUNT) {
+        micros >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void NotionLatencyHistogram::Record(uint64_t micros, idx_t count_p) {
+    buckets[BucketIndex(micros)] += count_p;
+    count += count_p;
+    total_micros += micros;
+    auto current_max = max_micros.load();
+    while (micros > current_max && !max_micros.compare_exchange_weak(current_max, micros)) {
+    }
+}
+
+void NotionLatencyHistogram::Reset() {
+    for (auto &bucket : buckets) {
+        bucket = 0;
+    }
+    count = 0;
+    total_micros = 0;
+    max_micros = 0;
+}
+
+uint64_t NotionLatencyHistogram::Percentile(double quantile) const {
+    uint64_t total = 0;
+    for (auto &bucket : buckets) {
+        total += bucket;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    auto rank = static_cast<uint64_t>(quantile * double(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (idx_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return MinValue<uint64_t>(uint64_t(1) << (i + 1), max_micros);
+        }
+    }
+    return max_micros;
+}
+
+NotionStats &NotionStats::Get() {
+    // Like the connection pool, the stats live for the lifetime of the process
+    static auto stats = new NotionStats();
+    return *stats;
+}
+
+void NotionStats::Record(NotionStatPhase phase, uint64_t micros, idx_t count) {
+    phases[static_cast<idx_t>(phase)].Record(micros, count);
+}
+
+// Replaces database, page and block ids in the path by {id}, so calls group by endpoint
+static std::string EndpointName(const std::string &method, const std::string &url) {
+    auto path_start = url.find('/', url.find("://") + 3);
+    auto path = path_start == std::string::npos ? std::string("/") : url.substr(path_start);
+    path = path.substr(0, path.find('?'));
+
+    std::string result = method + " ";
+    size_t segment_start = 1;
+    while (segment_start <= path.size()) {
+        auto segment_end = path.find('/', segment_start);
+        if (segment_end == std::string::npos) {
+            segment_end = path.size();
+        }
+        auto segment = path.substr(segment_start, segment_end - segment_start);
+        bool is_id = segment.size() >= 32 && segment.find_first_not_of("0123456789abcdefABCDEF-") == std::string::npos;
+        result += "/" + (is_id ? std::string("{id}") : segment);
+        segment_start = segment_end + 1;
+    }
+    return result;
+}
+
+void NotionStats::RecordRequest(const std::string &method, const std::string &url, int status_code, idx_t retries,
+                                uint64_t micros, idx_t bytes) {
+    RequestKey key(EndpointName(method, url), status_code, retries);
+    std::lock_guard<std::mutex> guard(lock);
+    auto &entry = requests[key];
+    if (!entry) {
+        entry = make_uniq<RequestStats>();
+    }
+    entry->latency.Record(micros);
+    entry->bytes += bytes;
+}
+
+void NotionStats::Reset() {
+    for (auto &phase : phases) {
+        phase.Reset();
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    requests.clear();
+}
+
+static const char *PhaseName(NotionStatPhase phase) {
+    switch (phase) {
+    case NotionStatPhase::CONNECT:
+        return "connect";
+    case NotionStatPhase::RATE_LIMIT_WAIT:
+        return "rate_limit_wait";
+    case NotionStatPhase::RETRY_BACKOFF:
+        return "retry_backoff";
+    case NotionStatPhase::TIME_TO_FIRST_BYTE:
+        return "time_to_first_byte";
+    case NotionStatPhase::TRANSFER:
+        return "transfer";
+    case NotionStatPhase::DECOMPRESS:
+        return "decompress";
+    case NotionStatPhase::PARSE:
+        return "parse";
+    case NotionStatPhase::DECODE:
+        return "decode";
+    case NotionStatPhase::SERIALIZE:
+        return "serialize";
+    default:
+        return "unknown";
+    }
+}
+
+struct NotionStatsRow {
+    std::string category;
+    std::string name;
+    Value status_code;
+    Value retries;
+    uint64_t count;
+    uint64_t total_micros;
+    uint64_t p50_micros;
+    uint64_t p99_micros;
+    uint64_t max_micros;
+    Value bytes;
+};
+
+struct NotionStatsState : public GlobalTableFunctionState {
+    vector<NotionStatsRow> rows;
+    idx_t offset = 0;
+};
+
+static NotionStatsRow MakeRow(std::string category, std::string name, const NotionLatencyHistogram &histogram) {
+    NotionStatsRow row;
+    row.category = std::move(category);
+    row.name = std::move(name);
+    row.status_code = Value(LogicalType::INTEGER);
+    row.retries = Value(LogicalType::BIGINT);
+    row.count = histogram.Count();
+    row.total_micros = histogram.TotalMicros();
+    row.p50_micros = histogram.Percentile(0.5);
+    row.p99_micros = histogram.Percentile(0.99);
+    row.max_micros = histogram.MaxMicros();
+    row.bytes = Value(LogicalType::BIGINT);
+    return row;
+}
+
+struct NotionStatsFunctions {
+    // Snapshot of all metrics, taken when the scan starts
+    static vector<NotionStatsRow> Collect() {
+        auto &stats = NotionStats::Get();
+        vector<NotionStatsRow> rows;
+        {
+            std::lock_guard<std::mutex> guard(stats.lock);
+            for (auto &entry : stats.requests) {
+                auto row = MakeRow("request", std::get<0>(entry.first), entry.second->latency);
+                row.status_code = Value::INTEGER(std::get<1>(entry.first));
+                row.retries = Value::BIGINT(std::get<2>(entry.first));
+                row.bytes = Value::BIGINT(entry.second->bytes);
+                rows.push_back(std::move(row));
+            }
+        }
+        for (idx_t i = 0; i < static_cast<idx_t>(NotionStatPhase::COUNT); i++) {
+            auto &histogram = stats.phases[i];
+            if (histogram.Count() > 0) {
+                rows.push_back(MakeRow("phase", PhaseName(static_cast<NotionStatPhase>(i)), histogram));
+            }
+        }
+        return rows;
+    }
+};
+
+static double ToMillis(uint64_t micros) {
+    return double(micros) / 1000.0;
+}
+
+static unique_ptr<FunctionData> NotionStatsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                vector<LogicalType> &return_types, vector<string> &names) {
+    names = {"category", "name", "status_code", "retries", "count", "total_ms",
+             "avg_ms",   "p50_ms", "p99_ms",     "max_ms",  "bytes"};
+    return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::INTEGER, LogicalType::BIGINT,
+                    LogicalType::BIGINT,  LogicalType::DOUBLE,  LogicalType::DOUBLE,  LogicalType::DOUBLE,
+                    LogicalType::DOUBLE,  LogicalType::DOUBLE,  LogicalType::BIGINT};
+    return make_uniq<TableFunctionData>();
+}
+
+static unique_ptr<GlobalTableFunctionState> NotionStatsInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto state = make_uniq<NotionStatsState>();
+    state->rows = NotionStatsFunctions::Collect();
+    return std::move(state);
+}
+
+static void NotionStatsFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &state = data_p.global_state->Cast<NotionStatsState>();
+    idx_t count = 0;
+    while (state.offset < state.rows.size() && count < STANDARD_VECTOR_SIZE) {
+        auto &row = state.rows[state.offset++];
+        output.SetValue(0, count, Value(row.category));
+        output.SetValue(1, count, Value(row.name));
+        output.SetValue(2, count, row.status_code);
+        output.SetValue(3, count, row.retries);
+        output.SetValue(4, count, Value::BIGINT(row.count));
+        output.SetValue(5, count, Value::DOUBLE(ToMillis(row.total_micros)));
+        output.SetValue(6, count, Value::DOUBLE(row.count ? ToMillis(row.total_micros) / double(row.count) : 0));
+        output.SetValue(7, count, Value::DOUBLE(ToMillis(row.p50_micros)));
+        output.SetValue(8, count, Value::DOUBLE(ToMillis(row.p99_micros)));
+        output.SetValue(9, count, Value::DOUBLE(ToMillis(row.max_micros)));
+        output.SetValue(10, count, row.bytes);
+        count++;
+    }
+    output.SetCardinality(count);
+}
+
+struct NotionStatsResetState : public GlobalTableFunctionState {
+    bool done = false;
+};
+
+static unique_ptr<FunctionData> NotionStatsResetBind(ClientContext &context, TableFunctionBindInput &input,
+                                                     vector<LogicalType> &return_types, vector<string> &names) {
+    names.push_back("success");
+    return_types.push_back(LogicalType::BOOLEAN);
+    return make_uniq<TableFunctionData>();
+}
+
+static unique_ptr<GlobalTableFunctionState> NotionStatsResetInit(ClientContext &context,
+                                                                 TableFunctionInitInput &input) {
+    return make_uniq<NotionStatsResetState>();
+}
+
+static void NotionStatsResetFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &state = data_p.global_state->Cast<NotionStatsResetState>();
+    if (state.done) {
+        return;
+    }
+    state.done = true;
+
+    NotionStats::Get().Reset();
+    output.SetValue(0, 0, Value::BOOLEAN(true));
+    output.SetCardinality(1);
+}
+
+void NotionStats::RegisterFunctions(DatabaseInstance &db) {
+    TableFunction stats("notion_stats", {}, NotionStatsFunction, NotionStatsBind, NotionStatsInit);
+    ExtensionUtil::RegisterFunction(db, stats);
+
+    TableFunction stats_reset("notion_stats_reset", {}, NotionStatsResetFunction, NotionStatsResetBind,
+                              NotionStatsResetInit);
+    ExtensionUtil::RegisterFunction(db, stats_reset);
+}
+
+} // namespace duckdb
@@ -0,0 +1,248 @@
+#include "notion_sync.hpp"
+#include "notion_utils.hpp"
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/catalog/catalog_search_path.hpp"
+#include "duckdb/main/client_data.hpp"
+#include "duckdb/main/connection.hpp"
+#include "duckdb/main/database_manager.hpp"
+#include "duckdb/main/extension_util.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+#include "duckdb/planner/binder.hpp"
+
+namespace duckdb {
+
+// Watermarks of all synced tables, stored in the main schema of the default database whatever
+// catalog and schema the targets are in
+static const std::string SYNC_STATE_TABLE = "notion_sync_state";
+// Pages edited since the last sync, staged before they are merged into the target table
+static const std::string SYNC_CHANGES_TABLE = "notion_sync_changes";
+// Ids of all pages of the database, staged to find the pages deleted since the last sync
+static const std::string SYNC_IDS_TABLE = "notion_sync_ids";
+
+struct NotionSyncBindData : public TableFunctionData {
+    std::string database_id;
+    std::string target_table;
+    // The target table, qualified with the caller's default catalog and schema when it is not
+    QualifiedName target;
+    // The qualified target, which identifies its watermark in the sync state
+    std::string target_key;
+    // Reading the ids of every page costs a request per 100 pages, so it is opt-in
+    bool delete_missing = false;
+};
+
+struct NotionSyncGlobalState : public GlobalTableFunctionState {
+    bool done = false;
+};
+
+struct NotionSyncResult {
+    idx_t rows_synced = 0;
+    idx_t rows_deleted = 0;
+    bool full_refresh = false;
+    Value last_edited_time;
+};
+
+static unique_ptr<MaterializedQueryResult> RunQuery(Connection &con, const std::string &query) {
+    auto result = con.Query(query);
+    if (result->HasError()) {
+        result->ThrowError("notion_sync: ");
+    }
+    return result;
+}
+
+// Quotes each part of a possibly qualified table name
+static std::string QuoteTableName(const QualifiedName &name) {
+    std::string result;
+    if (!name.catalog.empty()) {
+        result += KeywordHelper::WriteOptionallyQuoted(name.catalog) + ".";
+    }
+    if (!name.schema.empty()) {
+        result += KeywordHelper::WriteOptionallyQuoted(name.schema) + ".";
+    }
+    return result + KeywordHelper::WriteOptionallyQuoted(name.name);
+}
+
+static std::string TimestampLiteral(const Value &value) {
+    return "TIMESTAMP " + KeywordHelper::WriteQuoted(value.ToString(), '\'');
+}
+
+// Adds the columns of properties created in Notion since the target table was created
+static void AddNewColumns(Connection &con, const QualifiedName &name, const std::string &source) {
+    auto &table = *Catalog::GetEntry<TableCatalogEntry>(*con.context, name.catalog, name.schema, name.name,
+                                                        OnEntryNotFound::THROW_EXCEPTION);
+    auto columns = RunQuery(con, "SELECT * FROM " + source + " LIMIT 0");
+    vector<std::string> added;
+    for (idx_t i = 0; i < columns->names.size(); i++) {
+        if (!table.ColumnExists(columns->names[i])) {
+            added.push_back("ALTER TABLE " + QuoteTableName(name) + " ADD COLUMN " +
+                            KeywordHelper::WriteOptionallyQuoted(columns->names[i]) + " " +
+                            columns->types[i].ToString());
+        }
+    }
+    // The catalog entry is not used once the table is altered
+    for (const auto &statement : added) {
+        RunQuery(con, statement);
+    }
+}
+
+static NotionSyncResult RunSync(Connection &con, const NotionSyncBindData &bind_data) {
+    NotionSyncResult sync;
+    auto target = QuoteTableName(bind_data.target);
+    auto database_literal = KeywordHelper::WriteQuoted(bind_data.database_id, '\'');
+    auto target_literal = KeywordHelper::WriteQuoted(bind_data.target_key, '\'');
+    QualifiedName state_name;
+    state_name.catalog = DatabaseManager::GetDefaultDatabase(*con.context);
+    state_name.schema = DEFAULT_SCHEMA;
+    state_name.name = SYNC_STATE_TABLE;
+    auto state_table = QuoteTableName(state_name);
+
+    RunQuery(con, "CREATE TABLE IF NOT EXISTS " + state_table +
+                      " (database_id VARCHAR, target_table VARCHAR, last_edited_time TIMESTAMP,"
+                      " synced_at TIMESTAMP, PRIMARY KEY (database_id, target_table))");
+
+    auto state = RunQuery(con, "SELECT last_edited_time FROM " + state_table + " WHERE database_id = " +
+                                   database_literal + " AND target_table = " + target_literal);
+    Value watermark;
+    if (state->RowCount() > 0) {
+        watermark = state->GetValue(0, 0);
+    }
+
+    // Without a watermark, or when the target was dropped since, the whole database is loaded.
+    // The target is looked up in the catalog: a failing query would abort the transaction.
+    bool target_exists = Catalog::GetEntry<TableCatalogEntry>(*con.context, bind_data.target.catalog,
+                                                              bind_data.target.schema, bind_data.target.name,
+                                                              OnEntryNotFound::RETURN_NULL) != nullptr;
+    sync.full_refresh = watermark.IsNull() || !target_exists;
+
+    // Options are stored as text, so options added to the database later still fit the table
+    std::string source;
+    if (sync.full_refresh) {
+        RunQuery(con, "CREATE OR REPLACE TABLE " + target + " AS SELECT * FROM read_notion(" + database_literal +
+                          ", enum_types := false)");
+        source = target;
+    } else {
+        // Notion reports edit times at minute precision, so the pages edited in the minute of
+        // the watermark are read again; merging by id makes that harmless
+        RunQuery(con, "CREATE OR REPLACE TEMPORARY TABLE " + SYNC_CHANGES_TABLE + " AS SELECT * FROM read_notion(" +
+                          database_literal + ", edited_since := " + TimestampLiteral(watermark) +
+                          ", enum_types := false)");
+        AddNewColumns(con, bind_data.target, SYNC_CHANGES_TABLE);
+        RunQuery(con, "DELETE FROM " + target + " WHERE id IN (SELECT id FROM " + SYNC_CHANGES_TABLE + ")");
+        RunQuery(con, "INSERT INTO " + target + " BY NAME SELECT * FROM " + SYNC_CHANGES_TABLE);
+        source = SYNC_CHANGES_TABLE;
+
+        if (bind_data.delete_missing) {
+            // Queries do not return trashed or archived pages, and there is no feed of deletions,
+            // so the ids of all pages are read (a single projected property per page) and the
+            // pages missing from them are deleted
+            RunQuery(con, "CREATE OR REPLACE TEMPORARY TABLE " + SYNC_IDS_TABLE + " AS SELECT id FROM read_notion(" +
+                              database_literal + ", enum_types := false)");
+            auto deleted = RunQuery(con, "DELETE FROM " + target + " WHERE id NOT IN (SELECT id FROM " +
+                                             SYNC_IDS_TABLE + ")");
+            sync.rows_deleted = deleted->GetValue(0, 0).GetValue<int64_t>();
+            RunQuery(con, "DROP TABLE " + SYNC_IDS_TABLE);
+        }
+    }
+
+    auto summary = RunQuery(con, "SELECT count(*), max(last_edited_time) FROM " + source);
+    sync.rows_synced = summary->GetValue(0, 0).GetValue<int64_t>();
+    sync.last_edited_time = summary->GetValue(1, 0);
+    if (sync.last_edited_time.IsNull()) {
+        // Nothing changed since the last sync
+        sync.last_edited_time = watermark;
+    }
+    if (!sync.full_refresh) {
+        RunQuery(con, "DROP TABLE " + SYNC_CHANGES_TABLE);
+    }
+
+    auto new_watermark = sync.last_edited_time.IsNull() ? "NULL" : TimestampLiteral(sync.last_edited_time);
+    RunQuery(con, "INSERT OR REPLACE INTO " + state_table + " VALUES (" + database_literal + ", " +
+                      target_literal + ", " + new_watermark + ", now()::TIMESTAMP)");
+    return sync;
+}
+
+static unique_ptr<FunctionData> NotionSyncBind(ClientContext &context, TableFunctionBindInput &input,
+                                               vector<LogicalType> &return_types, vector<string> &names) {
+    auto bind_data = make_uniq<NotionSyncBindData>();
+    bind_data->database_id = NotionUtils::ExtractDatabaseId(input.inputs[0].ToString());
+    bind_data->target_table = input.inputs[1].ToString();
+    for (auto &parameter : input.named_parameters) {
+        if (parameter.first == "delete_missing") {
+            bind_data->delete_missing = parameter.second.GetValue<bool>();
+        }
+    }
+
+    // The sync runs on a connection of its own, which would resolve an unqualified name in the
+    // database's default schema rather than in the caller's current one
+    auto &target = bind_data->target;
+    target = QualifiedName::Parse(bind_data->target_table);
+    // "x.t" names schema x, or catalog x when there is no such schema
+    Binder::BindSchemaOrCatalog(context, target.catalog, target.schema);
+    auto current = ClientData::Get(context).catalog_search_path->GetDefault();
+    if (target.catalog.empty()) {
+        target.catalog = current.catalog;
+    }
+    if (target.schema.empty()) {
+        target.schema = target.catalog == current.catalog ? current.schema : std::string(DEFAULT_SCHEMA);
+    }
+    // The same name may be a different table after USE, so watermarks are kept per qualified table
+    bind_data->target_key = QuoteTableName(target);
+
+    names = {"database_id", "target_table", "rows_synced", "rows_deleted", "full_refresh", "last_edited_time"};
+    return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::BIGINT,
+                    LogicalType::BOOLEAN, LogicalType::TIMESTAMP};
+    return std::move(bind_data);
+}
+
+static unique_ptr<GlobalTableFunctionState> NotionSyncInit(ClientContext &context, TableFunctionInitInput &input) {
+    return make_uniq<NotionSyncGlobalState>();
+}
+
+static void NotionSyncFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &bind_data = data_p.bind_data->Cast<NotionSyncBindData>();
+    auto &state = data_p.global_state->Cast<NotionSyncGlobalState>();
+    if (state.done) {
+        return;
+    }
+    state.done = true;
+
+    // The merge runs on a connection of its own, as queries cannot be run on the caller's while its
+    // query executes. Its transaction makes the target table and its watermark change together;
+    // it commits independently of the caller's transaction and does not see its uncommitted
+    // changes. The caller's session settings (e.g. notion_scan_partitions) are carried over.
+    Connection con(*context.db);
+    con.context->config.set_variables = context.config.set_variables;
+    // Both queries must see the current pages: a cached id list would delete pages created since
+    // it was cached, and a cached change query would miss edits. An empty directory disables the
+    // page cache, also when it is set globally.
+    con.context->config.set_variables["notion_cache_directory"] = Value("");
+    con.BeginTransaction();
+    NotionSyncResult sync;
+    try {
+        sync = RunSync(con, bind_data);
+    } catch (...) {
+        con.Rollback();
+        throw;
+    }
+    con.Commit();
+
+    output.SetValue(0, 0, Value(bind_data.database_id));
+    output.SetValue(1, 0, Value(bind_data.target_table));
+    output.SetValue(2, 0, Value::BIGINT(sync.rows_synced));
+    output.SetValue(3, 0, Value::BIGINT(sync.rows_deleted));
+    output.SetValue(4, 0, Value::BOOLEAN(sync.full_refresh));
+    output.SetValue(5, 0, sync.last_edited_time.IsNull() ? Value(LogicalType::TIMESTAMP) : sync.last_edited_time);
+    output.SetCardinality(1);
+}
+
+void NotionSync::RegisterTableFunction(DatabaseInstance &db) {
+    TableFunction notion_sync("notion_sync", {LogicalType::VARCHAR, LogicalType::VARCHAR}, NotionSyncFunction,
+                              NotionSyncBind, NotionSyncInit);
+    notion_sync.named_parameters["delete_missing"] = LogicalType::BOOLEAN;
+    ExtensionUtil::RegisterFunction(db, notion_sync);
+}
+
+} // namespace duckdb
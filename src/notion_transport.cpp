@@ -0,0 +1,902 @@
+#include "notion_transport.hpp"
+#include "notion_connection_pool.hpp"
+#include "notion_stats.hpp"
+#include "notion_utils.hpp"
+#include "duckdb/common/exception.hpp"
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <openssl/err.h>
+#include <cerrno>
+#include <csignal>
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace duckdb {
+
+// Case-insensitive check for an HTTP header name at the start of a header line
+static bool HeaderNameEquals(const std::string &line, size_t colon, const char *name) {
+    size_t name_len = strlen(name);
+    if (colon != name_len) {
+        return false;
+    }
+    for (size_t i = 0; i < name_len; i++) {
+        if (tolower(static_cast<unsigned char>(line[i])) != name[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The zlib state of a gzip body being inflated. zlib keeps a pointer to the stream, so it is
+// allocated once and never moved.
+struct NotionInflater {
+    z_stream stream;
+    bool initialized = false;
+    bool finished = false;
+
+    ~NotionInflater() {
+        if (initialized) {
+            inflateEnd(&stream);
+        }
+    }
+};
+
+NotionHttpParser::NotionHttpParser() {
+}
+
+NotionHttpParser::~NotionHttpParser() {
+}
+
+NotionHttpParser::NotionHttpParser(NotionHttpParser &&other) noexcept = default;
+NotionHttpParser &NotionHttpParser::operator=(NotionHttpParser &&other) noexcept = default;
+
+bool NotionHttpParser::Inflate(idx_t count) {
+    if (count == 0) {
+        return true;
+    }
+    auto phase_start = std::chrono::steady_clock::now();
+    if (!inflater) {
+        inflater = make_uniq<NotionInflater>();
+        memset(&inflater->stream, 0, sizeof(inflater->stream));
+        // 16 + MAX_WBITS selects the gzip format
+        if (inflateInit2(&inflater->stream, 16 + MAX_WBITS) != Z_OK) {
+            return false;
+        }
+        inflater->initialized = true;
+    }
+    auto &stream = inflater->stream;
+    stream.next_in = reinterpret_cast<Bytef *>(&buffer[0]);
+    stream.avail_in = static_cast<uInt>(count);
+    bool failed = false;
+    // Bytes after the end of the gzip stream are ignored
+    while (stream.avail_in > 0 && !inflater->finished) {
+        if (inflated_size == inflated.size()) {
+            inflated.resize(std::max<idx_t>(inflated.size() * 2, READ_SIZE));
+        }
+        stream.next_out = reinterpret_cast<Bytef *>(&inflated[inflated_size]);
+        stream.avail_out = static_cast<uInt>(inflated.size() - inflated_size);
+        int status = inflate(&stream, Z_NO_FLUSH);
+        inflated_size = inflated.size() - stream.avail_out;
+        if (status == Z_STREAM_END) {
+            inflater->finished = true;
+        } else if (status != Z_OK && !(status == Z_BUF_ERROR && stream.avail_out == 0)) {
+            failed = true;
+            break;
+        }
+    }
+    buffer.erase(0, count);
+    size = buffer.size();
+    inflated_in += count;
+    inflate_micros += NotionStats::ElapsedMicros(phase_start);
+    return !failed;
+}
+
+char *NotionHttpParser::Reserve(idx_t reserve_size) {
+    buffer.resize(size + reserve_size);
+    return &buffer[size];
+}
+
+bool NotionHttpParser::Commit(idx_t read_size) {
+    size += read_size;
+    buffer.resize(size);
+    return Advance();
+}
+
+bool NotionHttpParser::Close() {
+    if (state == State::BODY_CLOSE) {
+        state = State::DONE;
+    }
+    return state == State::DONE;
+}
+
+void NotionHttpParser::ParseHeaders(const std::string &headers) {
+    // Extract status code
+    size_t status_pos = headers.find(" ");
+    char *end;
+    if (status_pos == std::string::npos || status_pos + 4 > headers.size() ||
+        (response.status_code = static_cast<int>(strtol(headers.c_str() + status_pos + 1, &end, 10))) == 0) {
+        state = State::FAILED;
+        return;
+    }
+
+    // Parse the headers that determine message framing
+    bool has_content_length = false;
+    bool chunked = false;
+    keep_alive = true;
+    size_t line_start = headers.find("\r\n");
+    while (line_start != std::string::npos) {
+        line_start += 2;
+        size_t line_end = headers.find("\r\n", line_start);
+        std::string line = headers.substr(line_start, line_end == std::string::npos ? std::string::npos : line_end - line_start);
+        size_t colon = line.find(":");
+        if (colon != std::string::npos) {
+            std::string value = line.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+            std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+            if (HeaderNameEquals(line, colon, "content-length")) {
+                has_content_length = true;
+                content_length = strtoull(value.c_str(), nullptr, 10);
+            } else if (HeaderNameEquals(line, colon, "transfer-encoding")) {
+                chunked = value.find("chunked") != std::string::npos;
+            } else if (HeaderNameEquals(line, colon, "content-encoding")) {
+                gzip = value.find("gzip") != std::string::npos;
+            } else if (HeaderNameEquals(line, colon, "connection")) {
+                keep_alive = value.find("close") == std::string::npos;
+            } else if (HeaderNameEquals(line, colon, "retry-after")) {
+                // Notion sends delay-seconds; an HTTP date is ignored in favor of the backoff
+                double seconds = strtod(value.c_str(), &end);
+                if (end != value.c_str() && seconds > 0) {
+                    response.retry_after = seconds;
+                }
+            }
+        }
+        line_start = line_end;
+    }
+
+    if (response.status_code == 204 || response.status_code == 304) {
+        // No message body
+        state = State::DONE;
+    } else if (chunked) {
+        state = State::CHUNK_SIZE;
+    } else if (has_content_length) {
+        state = State::BODY_LENGTH;
+    } else {
+        // Unframed body: read until the server closes the connection
+        state = State::BODY_CLOSE;
+        keep_alive = false;
+    }
+}
+
+bool NotionHttpParser::Advance() {
+    while (true) {
+        switch (state) {
+        case State::HEADERS: {
+            // Only the newly read bytes are searched for the end of the headers
+            size_t header_end = buffer.find("\r\n\r\n", searched);
+            if (header_end == std::string::npos) {
+                searched = size < 3 ? 0 : size - 3;
+                return false;
+            }
+            ParseHeaders(buffer.substr(0, header_end));
+            buffer.erase(0, header_end + 4);
+            size = buffer.size();
+            if (state == State::BODY_LENGTH && !gzip) {
+                // Size the buffer once for the whole body
+                buffer.reserve(content_length);
+            } else if (state == State::DONE) {
+                buffer.clear();
+                size = 0;
+            }
+            break;
+        }
+        case State::BODY_LENGTH:
+            if (gzip) {
+                if (!Inflate(MinValue<idx_t>(size, content_length - inflated_in))) {
+                    state = State::FAILED;
+                    return false;
+                }
+                if (inflated_in < content_length) {
+                    return false;
+                }
+                state = State::DONE;
+                break;
+            }
+            if (size < content_length) {
+                return false;
+            }
+            // The buffer holds just the body now, so it becomes the body without a copy
+            buffer.resize(content_length);
+            size = content_length;
+            state = State::DONE;
+            break;
+        case State::CHUNK_SIZE: {
+            size_t size_end = buffer.find("\r\n", pos);
+            if (size_end == std::string::npos) {
+                return false;
+            }
+            char *end;
+            chunk_size = strtoull(buffer.c_str() + pos, &end, 16);
+            if (end == buffer.c_str() + pos) {
+                state = State::FAILED;
+                return false;
+            }
+            pos = size_end + 2;
+            state = chunk_size == 0 ? State::CHUNK_TRAILER : State::CHUNK_DATA;
+            break;
+        }
+        case State::CHUNK_DATA:
+            if (size < pos + chunk_size + 2) {
+                return false;
+            }
+            // Chunks are decoded in place: their data is moved down over the framing already read
+            memmove(&buffer[body_size], &buffer[pos], chunk_size);
+            body_size += chunk_size;
+            pos += chunk_size + 2;
+            state = State::CHUNK_SIZE;
+            if (gzip) {
+                if (!Inflate(body_size)) {
+                    state = State::FAILED;
+                    return false;
+                }
+                pos -= body_size;
+                body_size = 0;
+            }
+            break;
+        case State::CHUNK_TRAILER: {
+            // Skip optional trailers up to the terminating empty line
+            if (size >= pos + 2 && buffer.compare(pos, 2, "\r\n") == 0) {
+                buffer.resize(body_size);
+                size = body_size;
+                state = State::DONE;
+                break;
+            }
+            size_t trailer_end = buffer.find("\r\n", pos);
+            if (trailer_end == std::string::npos) {
+                return false;
+            }
+            pos = trailer_end + 2;
+            break;
+        }
+        case State::BODY_CLOSE:
+            if (gzip && !Inflate(size)) {
+                state = State::FAILED;
+            }
+            return false;
+        case State::DONE:
+            return true;
+        default:
+            return false;
+        }
+    }
+}
+
+NotionResponse NotionHttpParser::TakeResponse() {
+    if (gzip && inflated_in > 0) {
+        NotionStats::Get().Record(NotionStatPhase::DECOMPRESS, inflate_micros);
+        if (!inflater || !inflater->finished) {
+            // Report a failed response that was nevertheless read completely
+            response.body = "Failed to decompress response from Notion API";
+            response.status_code = 0;
+        } else {
+            inflated.resize(inflated_size);
+            // The buffer grew by doubling; a body held by a scan should not keep much spare room
+            if (inflated.capacity() - inflated.size() > inflated.size() / 4) {
+                inflated.shrink_to_fit();
+            }
+            response.body = std::move(inflated);
+        }
+        inflated.clear();
+        inflated_size = 0;
+        inflater.reset();
+        inflated_in = 0;
+        inflate_micros = 0;
+    } else {
+        response.body = std::move(buffer);
+    }
+    buffer.clear();
+    size = 0;
+    response.success = response.status_code >= 200 && response.status_code < 300;
+    return std::move(response);
+}
+
+#ifdef __linux__
+
+// Resolved addresses by host. Lookups block, so they run on a thread of their own, once per host,
+// and are only repeated after a connection to the address failed.
+struct NotionHostAddress {
+    sockaddr_storage address;
+    socklen_t length;
+};
+
+static std::mutex address_lock;
+static std::unordered_map<std::string, NotionHostAddress> host_addresses;
+
+static bool LookupHost(const std::string &host, NotionHostAddress &result) {
+    std::lock_guard<std::mutex> guard(address_lock);
+    auto entry = host_addresses.find(host);
+    if (entry == host_addresses.end()) {
+        return false;
+    }
+    result = entry->second;
+    return true;
+}
+
+// Looks the host up with getaddrinfo and caches its first address
+static void ResolveHost(const std::string &host, bool secure) {
+    NotionHostAddress result;
+    auto colon = host.find(':');
+    auto name = host.substr(0, colon);
+    auto port = colon == std::string::npos ? std::string(secure ? "443" : "80") : host.substr(colon + 1);
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addresses = nullptr;
+    if (getaddrinfo(name.c_str(), port.c_str(), &hints, &addresses) != 0 || !addresses) {
+        return;
+    }
+    memcpy(&result.address, addresses->ai_addr, addresses->ai_addrlen);
+    result.length = addresses->ai_addrlen;
+    freeaddrinfo(addresses);
+
+    std::lock_guard<std::mutex> guard(address_lock);
+    host_addresses[host] = result;
+}
+
+static void ForgetHost(const std::string &host) {
+    std::lock_guard<std::mutex> guard(address_lock);
+    host_addresses.erase(host);
+}
+
+// One request on an event loop: connecting, the TLS handshake, writing the request and reading
+// the response, each step resumed when its socket is ready
+struct NotionTransfer {
+    enum class State : uint8_t { CONNECTING, HANDSHAKE, WRITING, READING };
+
+    std::string host;
+    bool secure;
+    std::string request;
+    NotionTransport::Callback done;
+    std::chrono::steady_clock::time_point send_at;
+    // Set when nobody waits for the response anymore; a transfer not yet started is dropped
+    shared_ptr<std::atomic<bool>> cancelled;
+
+    State state = State::CONNECTING;
+    unique_ptr<NotionConnection> connection;
+    NotionHttpParser parser;
+    idx_t written = 0;
+    // Events the socket is registered for, 0 while it is not registered
+    uint32_t events = 0;
+    bool delivered = false;
+    bool received = false;
+    // A pooled connection that turns out to be closed is replaced once
+    bool replaced_stale = false;
+    // The host was looked up for this transfer, so a missing address means it does not resolve
+    bool resolved = false;
+    std::chrono::steady_clock::time_point phase_start;
+
+    bool Cancelled() const {
+        return cancelled && *cancelled;
+    }
+};
+
+class NotionEventLoop {
+public:
+    NotionEventLoop();
+
+    void Submit(unique_ptr<NotionTransfer> transfer);
+    // Makes the loop drop the cancelled transfers that wait for their send time
+    void Sweep();
+
+private:
+    void Run();
+    void Wake();
+    void Start(NotionTransfer &transfer);
+    // Moves the transfer aside until its host is resolved on a background thread
+    void Resolve(NotionTransfer &transfer);
+    bool Connect(NotionTransfer &transfer, const NotionHostAddress &address);
+    void Drop(unique_ptr<NotionTransfer> transfer);
+    void Advance(NotionTransfer &transfer);
+    // Waits for the socket as asked by a TLS call that could not complete; false on a TLS error
+    bool WaitForSsl(NotionTransfer &transfer, int result);
+    void Watch(NotionTransfer &transfer, uint32_t events);
+    void Unwatch(NotionTransfer &transfer);
+    void Finish(NotionTransfer &transfer);
+    void Fail(NotionTransfer &transfer, const std::string &error);
+    void Complete(NotionTransfer &transfer, NotionResponse response);
+
+    int epoll_fd;
+    int wake_fd;
+    std::mutex lock;
+    vector<unique_ptr<NotionTransfer>> submitted;
+    // Hosts whose lookup finished since the loop last woke up
+    vector<std::string> resolved_hosts;
+    std::atomic<bool> sweep {false};
+    // Owned by the loop thread: transfers waiting for their send time, transfers waiting for
+    // their host to be resolved, and transfers in progress
+    std::multimap<std::chrono::steady_clock::time_point, unique_ptr<NotionTransfer>> waiting;
+    std::unordered_map<std::string, vector<unique_ptr<NotionTransfer>>> resolving;
+    std::unordered_map<NotionTransfer *, unique_ptr<NotionTransfer>> active;
+};
+
+NotionEventLoop::NotionEventLoop() {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || wake_fd < 0) {
+        throw IOException("Failed to create the Notion event loop");
+    }
+    // The wake-up descriptor is the only one registered without a transfer
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+    std::thread(&NotionEventLoop::Run, this).detach();
+}
+
+void NotionEventLoop::Submit(unique_ptr<NotionTransfer> transfer) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        submitted.push_back(std::move(transfer));
+    }
+    Wake();
+}
+
+void NotionEventLoop::Sweep() {
+    sweep = true;
+    Wake();
+}
+
+void NotionEventLoop::Wake() {
+    uint64_t value = 1;
+    auto written = write(wake_fd, &value, sizeof(value));
+    (void)written;
+}
+
+void NotionEventLoop::Run() {
+    // Writing to a connection the server closed must fail with EPIPE rather than kill the process
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    static constexpr int MAX_EVENTS = 64;
+    // Send times far ahead (a long Retry-After) are waited for in steps that fit epoll's int timeout
+    static constexpr int64_t MAX_TIMEOUT_MILLIS = 60000;
+    epoll_event events[MAX_EVENTS];
+    while (true) {
+        int timeout = -1;
+        if (!waiting.empty()) {
+            auto delay = waiting.begin()->first - std::chrono::steady_clock::now();
+            auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(delay).count();
+            // Round up, so the loop does not wake just before the send time
+            timeout = static_cast<int>(std::max<int64_t>(std::min<int64_t>(millis, MAX_TIMEOUT_MILLIS) + 1, 0));
+        }
+        int count = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout);
+        for (int i = 0; i < count; i++) {
+            if (!events[i].data.ptr) {
+                uint64_t value;
+                auto read_size = read(wake_fd, &value, sizeof(value));
+                (void)read_size;
+                continue;
+            }
+            // Every transfer has a single socket, so a transfer completed by an earlier event of
+            // this batch cannot have another one
+            Advance(*static_cast<NotionTransfer *>(events[i].data.ptr));
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            for (auto &transfer : submitted) {
+                auto send_at = transfer->send_at;
+                waiting.emplace(send_at, std::move(transfer));
+            }
+            submitted.clear();
+            for (auto &host : resolved_hosts) {
+                auto entry = resolving.find(host);
+                if (entry == resolving.end()) {
+                    continue;
+                }
+                for (auto &transfer : entry->second) {
+                    transfer->resolved = true;
+                    auto send_at = transfer->send_at;
+                    waiting.emplace(send_at, std::move(transfer));
+                }
+                resolving.erase(entry);
+            }
+            resolved_hosts.clear();
+        }
+        if (sweep.exchange(false)) {
+            for (auto entry = waiting.begin(); entry != waiting.end();) {
+                if (!entry->second->Cancelled()) {
+                    ++entry;
+                    continue;
+                }
+                auto transfer = std::move(entry->second);
+                entry = waiting.erase(entry);
+                Drop(std::move(transfer));
+            }
+        }
+        auto now = std::chrono::steady_clock::now();
+        while (!waiting.empty() && waiting.begin()->first <= now) {
+            auto transfer = std::move(waiting.begin()->second);
+            waiting.erase(waiting.begin());
+            if (transfer->Cancelled()) {
+                Drop(std::move(transfer));
+                continue;
+            }
+            auto &started = *transfer;
+            active[&started] = std::move(transfer);
+            Start(started);
+        }
+    }
+}
+
+void NotionEventLoop::Start(NotionTransfer &transfer) {
+    transfer.phase_start = std::chrono::steady_clock::now();
+    transfer.connection = NotionConnectionPool::Get().AcquireIdle(transfer.host, transfer.secure, true);
+    if (transfer.connection) {
+        transfer.state = NotionTransfer::State::WRITING;
+        Advance(transfer);
+        return;
+    }
+    NotionHostAddress address;
+    if (!LookupHost(transfer.host, address)) {
+        if (transfer.resolved) {
+            Fail(transfer, "Failed to resolve Notion API host " + transfer.host);
+        } else {
+            Resolve(transfer);
+        }
+        return;
+    }
+    if (!Connect(transfer, address)) {
+        Fail(transfer, "Failed to connect to Notion API");
+        return;
+    }
+    // The socket becomes writable once the connection is established (or failed)
+    Watch(transfer, EPOLLOUT);
+}
+
+void NotionEventLoop::Resolve(NotionTransfer &transfer) {
+    auto entry = active.find(&transfer);
+    auto owned = std::move(entry->second);
+    active.erase(entry);
+    auto &pending = resolving[transfer.host];
+    pending.push_back(std::move(owned));
+    if (pending.size() > 1) {
+        // A lookup of the host is already running
+        return;
+    }
+    auto host = transfer.host;
+    auto secure = transfer.secure;
+    // Loops are never destroyed, so the thread may outlive the transfer but not the loop
+    std::thread([this, host, secure]() {
+        ResolveHost(host, secure);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            resolved_hosts.push_back(host);
+        }
+        Wake();
+    }).detach();
+}
+
+bool NotionEventLoop::Connect(NotionTransfer &transfer, const NotionHostAddress &address) {
+    int fd = socket(address.address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    transfer.connection = make_uniq<NotionConnection>();
+    transfer.connection->host = transfer.host;
+    transfer.connection->secure = transfer.secure;
+    transfer.connection->fd = fd;
+    auto target = reinterpret_cast<const sockaddr *>(&address.address);
+    if (connect(fd, target, address.length) < 0 && errno != EINPROGRESS) {
+        ForgetHost(transfer.host);
+        return false;
+    }
+    transfer.state = NotionTransfer::State::CONNECTING;
+    return true;
+}
+
+bool NotionEventLoop::WaitForSsl(NotionTransfer &transfer, int result) {
+    switch (SSL_get_error(transfer.connection->ssl, result)) {
+    case SSL_ERROR_WANT_READ:
+        Watch(transfer, EPOLLIN);
+        return true;
+    case SSL_ERROR_WANT_WRITE:
+        Watch(transfer, EPOLLOUT);
+        return true;
+    default:
+        return false;
+    }
+}
+
+void NotionEventLoop::Advance(NotionTransfer &transfer) {
+    auto &connection = *transfer.connection;
+    // TLS errors are reported through a per-thread queue, which must not hold earlier errors
+    ERR_clear_error();
+    while (true) {
+        switch (transfer.state) {
+        case NotionTransfer::State::CONNECTING: {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            if (getsockopt(connection.fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0) {
+                ForgetHost(transfer.host);
+                Fail(transfer, "Failed to connect to Notion API");
+                return;
+            }
+            if (!transfer.secure) {
+                NotionStats::Get().Record(NotionStatPhase::CONNECT, NotionStats::ElapsedMicros(transfer.phase_start));
+                transfer.state = NotionTransfer::State::WRITING;
+                break;
+            }
+            connection.ssl = NotionConnectionPool::Get().NewSsl(transfer.host);
+            if (!connection.ssl) {
+                Fail(transfer, "Failed to create SSL context");
+                return;
+            }
+            SSL_set_fd(connection.ssl, connection.fd);
+            transfer.state = NotionTransfer::State::HANDSHAKE;
+            break;
+        }
+        case NotionTransfer::State::HANDSHAKE: {
+            int result = SSL_connect(connection.ssl);
+            if (result != 1) {
+                if (!WaitForSsl(transfer, result)) {
+                    Fail(transfer, "Failed to connect to Notion API");
+                }
+                return;
+            }
+            NotionStats::Get().Record(NotionStatPhase::CONNECT, NotionStats::ElapsedMicros(transfer.phase_start));
+            transfer.state = NotionTransfer::State::WRITING;
+            break;
+        }
+        case NotionTransfer::State::WRITING: {
+            while (transfer.written < transfer.request.size()) {
+                auto data = transfer.request.data() + transfer.written;
+                auto remaining = transfer.request.size() - transfer.written;
+                int64_t result;
+                if (transfer.secure) {
+                    result = SSL_write(connection.ssl, data, static_cast<int>(remaining));
+                    if (result <= 0) {
+                        if (!WaitForSsl(transfer, static_cast<int>(result))) {
+                            Fail(transfer, "Failed to send request");
+                        }
+                        return;
+                    }
+                } else {
+                    result = send(connection.fd, data, remaining, MSG_NOSIGNAL);
+                    if (result < 0) {
+                        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                            Watch(transfer, EPOLLOUT);
+                        } else {
+                            Fail(transfer, "Failed to send request");
+                        }
+                        return;
+                    }
+                }
+                transfer.written += result;
+                transfer.delivered = true;
+            }
+            transfer.state = NotionTransfer::State::READING;
+            transfer.phase_start = std::chrono::steady_clock::now();
+            break;
+        }
+        case NotionTransfer::State::READING: {
+            while (true) {
+                bool headers_read = transfer.parser.HeadersRead();
+                auto buffer = transfer.parser.Reserve(NotionHttpParser::READ_SIZE);
+                int64_t result;
+                bool closed = false;
+                if (transfer.secure) {
+                    result = SSL_read(connection.ssl, buffer, static_cast<int>(NotionHttpParser::READ_SIZE));
+                    if (result <= 0) {
+                        transfer.parser.Commit(0);
+                        if (WaitForSsl(transfer, static_cast<int>(result))) {
+                            return;
+                        }
+                        closed = true;
+                    }
+                } else {
+                    result = recv(connection.fd, buffer, NotionHttpParser::READ_SIZE, 0);
+                    if (result <= 0) {
+                        transfer.parser.Commit(0);
+                        if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                            Watch(transfer, EPOLLIN);
+                            return;
+                        }
+                        closed = true;
+                    }
+                }
+                if (closed) {
+                    // The server closed the connection, which ends an unframed body
+                    if (transfer.parser.Close()) {
+                        Finish(transfer);
+                    } else {
+                        Fail(transfer, "Failed to read response from Notion API");
+                    }
+                    return;
+                }
+
+                transfer.received = true;
+                bool complete = transfer.parser.Commit(result);
+                if (transfer.parser.Failed()) {
+                    Fail(transfer, "Failed to read response from Notion API");
+                    return;
+                }
+                if (!headers_read && transfer.parser.HeadersRead()) {
+                    NotionStats::Get().Record(NotionStatPhase::TIME_TO_FIRST_BYTE,
+                                              NotionStats::ElapsedMicros(transfer.phase_start));
+                    transfer.phase_start = std::chrono::steady_clock::now();
+                }
+                if (complete) {
+                    Finish(transfer);
+                    return;
+                }
+            }
+        }
+        }
+    }
+}
+
+void NotionEventLoop::Watch(NotionTransfer &transfer, uint32_t events) {
+    if (transfer.events == events) {
+        return;
+    }
+    epoll_event event;
+    event.events = events;
+    event.data.ptr = &transfer;
+    epoll_ctl(epoll_fd, transfer.events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, transfer.connection->fd, &event);
+    transfer.events = events;
+}
+
+void NotionEventLoop::Unwatch(NotionTransfer &transfer) {
+    if (transfer.events != 0) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, transfer.connection->fd, nullptr);
+        transfer.events = 0;
+    }
+}
+
+void NotionEventLoop::Finish(NotionTransfer &transfer) {
+    Unwatch(transfer);
+    NotionStats::Get().Record(NotionStatPhase::TRANSFER, NotionStats::ElapsedMicros(transfer.phase_start));
+    bool keep_alive = transfer.parser.KeepAlive();
+    auto response = transfer.parser.TakeResponse();
+    NotionConnectionPool::Get().Release(std::move(transfer.connection), keep_alive);
+    Complete(transfer, std::move(response));
+}
+
+void NotionEventLoop::Fail(NotionTransfer &transfer, const std::string &error) {
+    bool stale = false;
+    if (transfer.connection) {
+        Unwatch(transfer);
+        // A pooled connection may have been closed by the server while idle; in that case
+        // nothing was received and the request is retried once on a fresh connection
+        stale = transfer.connection->reused && !transfer.received;
+        NotionConnectionPool::Get().Release(std::move(transfer.connection), false);
+    }
+    if (stale) {
+        transfer.delivered = false;
+    }
+    if (stale && !transfer.replaced_stale) {
+        transfer.replaced_stale = true;
+        transfer.parser = NotionHttpParser();
+        transfer.written = 0;
+        Start(transfer);
+        return;
+    }
+
+    NotionResponse response;
+    response.success = false;
+    response.status_code = 0;
+    response.body = error;
+    Complete(transfer, std::move(response));
+}
+
+void NotionEventLoop::Drop(unique_ptr<NotionTransfer> transfer) {
+    NotionResponse response;
+    response.success = false;
+    response.status_code = 0;
+    response.body = NotionRequests::CANCELLED_MESSAGE;
+    try {
+        transfer->done(std::move(response), false);
+    } catch (...) {
+        // See Complete
+    }
+}
+
+void NotionEventLoop::Complete(NotionTransfer &transfer, NotionResponse response) {
+    auto entry = active.find(&transfer);
+    auto owned = std::move(entry->second);
+    active.erase(entry);
+    try {
+        owned->done(std::move(response), owned->delivered);
+    } catch (...) {
+        // Callbacks hand results to waiting threads; a failure there must not stop the loop
+    }
+}
+
+#endif
+
+NotionTransport::NotionTransport() {
+}
+
+NotionTransport &NotionTransport::Get() {
+    // Never destroyed, like the connection pool its loops draw from
+    static auto transport = new NotionTransport();
+    return *transport;
+}
+
+void NotionTransport::SetIoThreads(ClientContext &context, SetScope scope, Value &parameter) {
+    NotionUtils::CheckGlobalScope(scope, "notion_io_threads");
+    Get().io_threads = parameter.GetValue<uint64_t>();
+}
+
+bool NotionTransport::Enabled() const {
+#ifdef __linux__
+    return io_threads > 0;
+#else
+    return false;
+#endif
+}
+
+void NotionTransport::Send(const std::string &host, bool secure, std::string request,
+                           std::chrono::steady_clock::time_point send_at, shared_ptr<std::atomic<bool>> cancelled,
+                           Callback done) {
+#ifdef __linux__
+    auto transfer = make_uniq<NotionTransfer>();
+    transfer->host = host;
+    transfer->secure = secure;
+    transfer->request = std::move(request);
+    transfer->send_at = send_at;
+    transfer->cancelled = std::move(cancelled);
+    transfer->done = std::move(done);
+
+    NotionEventLoop *loop;
+    try {
+        std::lock_guard<std::mutex> guard(lock);
+        // Loops are started as they are needed; lowering notion_io_threads leaves the extra ones idle
+        auto loop_count = MaxValue<idx_t>(io_threads, 1);
+        while (loops.size() < loop_count) {
+            loops.push_back(new NotionEventLoop());
+        }
+        loop = loops[next_loop++ % loop_count];
+    } catch (std::exception &ex) {
+        NotionResponse response;
+        response.success = false;
+        response.status_code = 0;
+        response.body = ex.what();
+        transfer->done(std::move(response), false);
+        return;
+    }
+    loop->Submit(std::move(transfer));
+#else
+    // Not reached: requests only go through the transport when it is enabled
+    NotionResponse response;
+    response.success = false;
+    response.status_code = 0;
+    response.body = "The Notion event loop transport is not available on this platform";
+    done(std::move(response), false);
+#endif
+}
+
+void NotionTransport::Sweep() {
+#ifdef __linux__
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto loop : loops) {
+        loop->Sweep();
+    }
+#endif
+}
+
+} // namespace duckdb
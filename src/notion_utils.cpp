@@ -1,4 +1,7 @@
 #include "notion_utils.hpp"
+#include "notion_json.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/types/timestamp.hpp"
 #include <regex>
 
 namespace duckdb {
@@ -36,30 +39,76 @@ bool NotionUtils::IsNotionUrl(const std::string &input) {
 }
 
 std::string NotionUtils::ParseJsonString(const std::string &json, const std::string &key) {
-    // Simple JSON parsing for string values
-    std::string search_key = "\"" + key + "\"";
-    size_t pos = json.find(search_key);
-    if (pos == std::string::npos) {
+    // Only top-level members match, so keys of nested objects (e.g. "parent") are never picked up
+    NotionJsonCursor cursor(json);
+    if (!cursor.EnterObject() || !cursor.FindKey(key.c_str())) {
         return "";
     }
 
-    pos = json.find(":", pos);
-    if (pos == std::string::npos) {
+    NotionJsonString value;
+    if (!cursor.ReadString(value)) {
         return "";
     }
+    return value.ToString();
+}
 
-    pos = json.find("\"", pos);
-    if (pos == std::string::npos) {
-        return "";
+void NotionUtils::AppendJsonString(std::string &out, const char *value, idx_t length) {
+    static const char *HEX_DIGITS = "0123456789abcdef";
+    out += '"';
+    idx_t run_start = 0;
+    for (idx_t i = 0; i < length; i++) {
+        auto c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(value + run_start, i - run_start);
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            out += "\\u00";
+            out += HEX_DIGITS[c >> 4];
+            out += HEX_DIGITS[c & 0xF];
+            break;
+        }
+        run_start = i + 1;
     }
-    pos++; // Skip opening quote
+    out.append(value + run_start, length - run_start);
+    out += '"';
+}
 
-    size_t end_pos = json.find("\"", pos);
-    if (end_pos == std::string::npos) {
-        return "";
+void NotionUtils::AppendJsonString(std::string &out, const std::string &value) {
+    AppendJsonString(out, value.data(), value.size());
+}
+
+std::string NotionUtils::ToIsoTimestamp(timestamp_t value) {
+    auto result = Timestamp::ToString(value);
+    auto separator = result.find(' ');
+    if (separator != std::string::npos) {
+        result[separator] = 'T';
     }
+    return result + "Z";
+}
 
-    return json.substr(pos, end_pos - pos);
+void NotionUtils::CheckGlobalScope(SetScope scope, const std::string &setting) {
+    if (scope != SetScope::GLOBAL) {
+        throw InvalidInputException("%s applies to every database and connection of the process; "
+                                    "change it with SET GLOBAL %s",
+                                    setting, setting);
+    }
 }
 
 } // namespace duckdb
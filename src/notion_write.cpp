@@ -2,88 +2,92 @@
 #include "notion_auth.hpp"
 #include "notion_requests.hpp"
 #include "notion_utils.hpp"
+#include "notion_stats.hpp"
+#include "notion_schema.hpp"
+#include "notion_schema_cache.hpp"
+#include "notion_decoder.hpp"
+#include "notion_page_stream.hpp"
+#include "notion_serializer.hpp"
 #include "duckdb/main/extension_util.hpp"
 #include "duckdb/common/exception.hpp"
-#include <sstream>
+#include "duckdb/common/string_util.hpp"
+#include <deque>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace duckdb {
 
+// Number of failed rows whose error messages are reported
+static constexpr idx_t MAX_REPORTED_ERRORS = 3;
+
 struct NotionCopyData : public TableFunctionData {
     std::string database_id;
     std::string auth_token;
-};
+    // Requests each sink thread keeps in flight
+    idx_t max_in_flight;
+    vector<string> column_names;
+    vector<LogicalType> column_types;
+    // Columns of the target database, and per copied column the index of its database column
+    vector<NotionColumn> target_columns;
+    vector<idx_t> target_column_ids;
+    // The copied columns that are written as properties
+    vector<NotionPropertyWriter> writers;
 
-struct NotionCopyGlobalState : public GlobalTableFunctionState {
-    idx_t rows_written = 0;
+    // Upsert mode (KEY option): rows are matched to existing pages by the key column
+    bool upsert = false;
+    idx_t key_column = 0;
+    idx_t page_id_column = 0;
+};
 
-    idx_t MaxThreads() const override {
-        return 1;
-    }
+// A page of the target database, as read before an upsert
+struct NotionExistingPage {
+    std::string page_id;
+    // Current value of each written property as the serializer renders it, so that it compares
+    // equal to the value a copied row would write; empty when the property would be left out
+    vector<std::string> properties;
 };
 
-// Helper to convert a row to Notion properties JSON
-static std::string RowToNotionProperties(const vector<string> &column_names,
-                                        const vector<LogicalType> &column_types,
-                                        DataChunk &chunk,
-                                        idx_t row_idx) {
-    std::stringstream properties;
-    properties << "{";
+struct NotionCopyGlobalState : public GlobalFunctionData {
+    // Existing pages by key value; only read after initialization
+    std::unordered_map<std::string, NotionExistingPage> existing_pages;
 
-    for (idx_t col_idx = 0; col_idx < column_names.size(); col_idx++) {
-        if (col_idx > 0) {
-            properties << ",";
-        }
+    std::mutex lock;
+    // Keys of the rows copied so far, so a key copied twice cannot create two pages
+    std::unordered_set<std::string> copied_keys;
+    idx_t rows_written = 0;
+    idx_t rows_unchanged = 0;
+    idx_t rows_failed = 0;
+    vector<std::string> errors;
+};
 
-        const auto &name = column_names[col_idx];
-        const auto &type = column_types[col_idx];
-        auto value = chunk.GetValue(col_idx, row_idx);
+struct NotionCopyLocalState : public LocalFunctionData {
+    NotionCopyLocalState(ClientContext &context, const vector<NotionPropertyWriter> &writers)
+        : serializer(context, writers) {
+    }
 
-        properties << "\"" << name << "\":";
+    NotionPropertySerializer serializer;
+    // Size of the last properties object, to size the next one up front
+    idx_t properties_size = 0;
+    // Scratch buffer for comparing rows with existing pages
+    std::string value_buffer;
+    // Page requests still in flight, oldest first
+    std::deque<NotionRequestFuture> in_flight;
+};
 
-        if (value.IsNull()) {
-            // For title properties, we need at least an empty array
-            if (col_idx == 0) {
-                properties << "{\"title\":[]}";
-            } else {
-                properties << "null";
-            }
-        } else {
-            // Determine Notion property type based on DuckDB type
-            switch (type.id()) {
-                case LogicalTypeId::VARCHAR: {
-                    // Assume first column is title, others are rich_text
-                    if (col_idx == 0) {
-                        properties << "{\"title\":[{\"text\":{\"content\":\""
-                                  << value.ToString() << "\"}}]}";
-                    } else {
-                        properties << "{\"rich_text\":[{\"text\":{\"content\":\""
-                                  << value.ToString() << "\"}}]}";
-                    }
-                    break;
-                }
-                case LogicalTypeId::INTEGER:
-                case LogicalTypeId::BIGINT:
-                case LogicalTypeId::DOUBLE:
-                case LogicalTypeId::FLOAT: {
-                    properties << "{\"number\":" << value.ToString() << "}";
-                    break;
-                }
-                case LogicalTypeId::BOOLEAN: {
-                    properties << "{\"checkbox\":" << (value.GetValue<bool>() ? "true" : "false") << "}";
-                    break;
-                }
-                default: {
-                    // Default to rich_text for unknown types
-                    properties << "{\"rich_text\":[{\"text\":{\"content\":\""
-                              << value.ToString() << "\"}}]}";
-                    break;
-                }
-            }
+static idx_t FindTargetColumn(const vector<NotionColumn> &columns, const std::string &name) {
+    for (idx_t i = 0; i < columns.size(); i++) {
+        if (columns[i].name == name) {
+            return i;
         }
     }
-
-    properties << "}";
-    return properties.str();
+    for (idx_t i = 0; i < columns.size(); i++) {
+        if (StringUtil::CIEquals(columns[i].name, name)) {
+            return i;
+        }
+    }
+    return DConstants::INVALID_INDEX;
 }
 
 static unique_ptr<FunctionData> NotionCopyBind(ClientContext &context, CopyFunctionBindInput &input,
@@ -92,60 +96,302 @@ static unique_ptr<FunctionData> NotionCopyBind(ClientContext &context, CopyFunct
     auto bind_data = make_uniq<NotionCopyData>();
 
     // Extract database ID from file path (which is the destination)
-    bind_data->database_id = NotionUtils::ExtractDatabaseId(input.file_path);
+    bind_data->database_id = NotionUtils::ExtractDatabaseId(input.info.file_path);
 
     // Get auth token
     bind_data->auth_token = NotionAuth::GetAuthToken(context);
 
+    bind_data->column_names = column_names;
+    bind_data->column_types = column_types;
+
+    Value setting;
+    bind_data->max_in_flight = NOTION_DEFAULT_COPY_CONCURRENCY;
+    if (context.TryGetCurrentSetting("notion_copy_concurrency", setting) && !setting.IsNull()) {
+        bind_data->max_in_flight = MaxValue<idx_t>(setting.GetValue<uint64_t>(), 1);
+    }
+
+    for (const auto &option : input.info.options) {
+        if (!StringUtil::CIEquals(option.first, "key")) {
+            throw BinderException("Unrecognized option for COPY TO notion: %s", option.first);
+        }
+        if (option.second.size() != 1) {
+            throw BinderException("COPY TO notion option KEY expects a single column name");
+        }
+        auto key_name = option.second[0].ToString();
+        bind_data->key_column = DConstants::INVALID_INDEX;
+        for (idx_t i = 0; i < column_names.size(); i++) {
+            if (StringUtil::CIEquals(column_names[i], key_name)) {
+                bind_data->key_column = i;
+            }
+        }
+        if (bind_data->key_column == DConstants::INVALID_INDEX) {
+            throw BinderException("COPY TO notion KEY column \"%s\" is not one of the copied columns", key_name);
+        }
+        bind_data->upsert = true;
+    }
+
+    // Map the copied columns to the database properties they are written to
+    auto db_response =
+        NotionSchemaCache::Get(context).GetDatabase(context, bind_data->database_id, bind_data->auth_token);
+    if (!db_response.success) {
+        throw InvalidInputException("Failed to get Notion database schema: " + db_response.body);
+    }
+    bind_data->target_columns = NotionSchema::GetColumns(NotionSchema::ParseProperties(db_response.body));
+    // Copied values are compared with the existing pages as text, as they need not be options yet
+    NotionSchema::UseTextTypes(bind_data->target_columns);
+    for (const auto &name : column_names) {
+        auto target_id = FindTargetColumn(bind_data->target_columns, name);
+        if (target_id == DConstants::INVALID_INDEX) {
+            throw BinderException("COPY TO notion column \"%s\" is not a property of the Notion database", name);
+        }
+        bind_data->target_column_ids.push_back(target_id);
+    }
+    bind_data->writers = NotionPropertySerializer::Bind(column_types, bind_data->target_columns,
+                                                        bind_data->target_column_ids);
+
+    if (bind_data->upsert) {
+        auto key_target = bind_data->target_column_ids[bind_data->key_column];
+        if (!bind_data->target_columns[key_target].is_property) {
+            throw BinderException("COPY TO notion KEY column \"%s\" is not a property of the Notion database",
+                                  column_names[bind_data->key_column]);
+        }
+        bind_data->page_id_column = DConstants::INVALID_INDEX;
+        for (idx_t i = 0; i < bind_data->target_columns.size(); i++) {
+            if (bind_data->target_columns[i].type == NotionPropertyType::PAGE_ID) {
+                bind_data->page_id_column = i;
+            }
+        }
+        if (bind_data->page_id_column == DConstants::INVALID_INDEX) {
+            throw BinderException("COPY TO notion with KEY requires the page id, but a property named \"id\" "
+                                  "hides it");
+        }
+    }
+
     return std::move(bind_data);
 }
 
-static unique_ptr<GlobalFunctionData> NotionCopyInit(ClientContext &context, FunctionData &bind_data_p) {
+// Renders a key value the same way for the copied rows and the existing pages
+static bool GetKeyString(const Value &value, const LogicalType &key_type, std::string &key) {
+    Value cast_value;
+    if (value.IsNull() || !value.DefaultTryCastAs(key_type, cast_value) || cast_value.IsNull()) {
+        return false;
+    }
+    key = cast_value.ToString();
+    return true;
+}
+
+// Reads the key and the copied properties of every page of the target database
+static void LoadExistingPages(ClientContext &context, const NotionCopyData &bind_data,
+                              NotionCopyGlobalState &gstate) {
+    // The output has the copied columns in copy order, so the copy's writers serialize it,
+    // followed by the page id
+    vector<idx_t> column_ids;
+    vector<LogicalType> types;
+    NotionQueryOptions options;
+    for (auto target_id : bind_data.target_column_ids) {
+        column_ids.push_back(target_id);
+        const auto &column = bind_data.target_columns[target_id];
+        types.push_back(column.logical_type);
+        if (column.is_property) {
+            options.filter_properties.push_back(column.property_id);
+        }
+    }
+    auto page_id_idx = column_ids.size();
+    column_ids.push_back(bind_data.page_id_column);
+    types.push_back(LogicalType::VARCHAR);
+
+    const auto &key_type = bind_data.target_columns[bind_data.target_column_ids[bind_data.key_column]].logical_type;
+    NotionPageDecoder decoder(bind_data.target_columns, column_ids);
+    // People are written by id, so they are compared by id
+    decoder.ReadPeopleIds();
+    NotionPropertySerializer serializer(context, bind_data.writers);
+    NotionPageStream stream(bind_data.database_id, bind_data.auth_token, options,
+                            NotionPageStream::DEFAULT_PREFETCH_DEPTH);
+    DataChunk chunk;
+    chunk.Initialize(context, types);
+
+    NotionResultPage page;
+    while (stream.Next(page)) {
+        for (idx_t offset = 0; offset < page.results.size(); offset += STANDARD_VECTOR_SIZE) {
+            chunk.Reset();
+            idx_t count = MinValue<idx_t>(page.results.size() - offset, STANDARD_VECTOR_SIZE);
+            for (idx_t row = 0; row < count; row++) {
+                const auto &result = page.results[offset + row];
+                decoder.Decode(page.body.data() + result.offset, result.length, chunk, row);
+            }
+            chunk.SetCardinality(count);
+            serializer.SetChunk(chunk);
+
+            for (idx_t row = 0; row < count; row++) {
+                std::string key;
+                if (!GetKeyString(chunk.GetValue(bind_data.key_column, row), key_type, key)) {
+                    continue;
+                }
+                // With duplicate keys in the database, the first page is updated
+                if (gstate.existing_pages.count(key)) {
+                    continue;
+                }
+                NotionExistingPage existing;
+                existing.page_id = chunk.GetValue(page_id_idx, row).ToString();
+                existing.properties.resize(bind_data.writers.size());
+                for (idx_t writer_idx = 0; writer_idx < bind_data.writers.size(); writer_idx++) {
+                    if (!serializer.SerializeValue(writer_idx, row, existing.properties[writer_idx])) {
+                        existing.properties[writer_idx].clear();
+                    }
+                }
+                gstate.existing_pages[key] = std::move(existing);
+            }
+        }
+    }
+}
+
+static unique_ptr<GlobalFunctionData> NotionCopyInitGlobal(ClientContext &context, FunctionData &bind_data_p,
+                                                           const string &file_path) {
+    auto &bind_data = bind_data_p.Cast<NotionCopyData>();
     auto state = make_uniq<NotionCopyGlobalState>();
+    if (bind_data.upsert) {
+        // One bulk read of the target up front, instead of a lookup per row
+        LoadExistingPages(context, bind_data, *state);
+    }
     return std::move(state);
 }
 
-static void NotionCopySink(ExecutionContext &context, FunctionData &bind_data_p, GlobalFunctionData &gstate_p,
-                          LocalFunctionData &lstate, DataChunk &input) {
+// True when writing the row would change a property of the existing page. Both sides are compared
+// as the JSON values the serializer sends, e.g. people by id and a NULL checkbox as false.
+static bool RowChanged(NotionCopyLocalState &lstate, const NotionExistingPage &existing, idx_t row) {
+    for (idx_t writer_idx = 0; writer_idx < existing.properties.size(); writer_idx++) {
+        lstate.value_buffer.clear();
+        if (!lstate.serializer.SerializeValue(writer_idx, row, lstate.value_buffer)) {
+            // The property is left alone
+            continue;
+        }
+        if (lstate.value_buffer != existing.properties[writer_idx]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static unique_ptr<LocalFunctionData> NotionCopyInitLocal(ExecutionContext &context, FunctionData &bind_data_p) {
     auto &bind_data = bind_data_p.Cast<NotionCopyData>();
-    auto &gstate = gstate_p.Cast<NotionCopyGlobalState>();
+    return make_uniq<NotionCopyLocalState>(context.client, bind_data.writers);
+}
 
-    // Get column information from the input chunk
-    vector<string> column_names;
-    vector<LogicalType> column_types;
+// Waits for the oldest in-flight requests until at most max_remaining are left
+static void DrainRequests(NotionCopyGlobalState &gstate, NotionCopyLocalState &lstate, idx_t max_remaining) {
+    while (lstate.in_flight.size() > max_remaining) {
+        auto response = lstate.in_flight.front().Get();
+        lstate.in_flight.pop_front();
 
-    for (idx_t i = 0; i < input.ColumnCount(); i++) {
-        column_names.push_back("Column" + std::to_string(i));
-        column_types.push_back(input.data[i].GetType());
+        std::lock_guard<std::mutex> guard(gstate.lock);
+        if (response.success) {
+            gstate.rows_written++;
+            continue;
+        }
+        // Keep going after a failed row; failures are reported once the COPY is done
+        gstate.rows_failed++;
+        if (gstate.errors.size() < MAX_REPORTED_ERRORS) {
+            gstate.errors.push_back(response.body);
+        }
     }
+}
+
+static void NotionCopySink(ExecutionContext &context, FunctionData &bind_data_p, GlobalFunctionData &gstate_p,
+                          LocalFunctionData &lstate_p, DataChunk &input) {
+    auto &bind_data = bind_data_p.Cast<NotionCopyData>();
+    auto &gstate = gstate_p.Cast<NotionCopyGlobalState>();
+    auto &lstate = lstate_p.Cast<NotionCopyLocalState>();
 
-    // Write each row to Notion
+    // Write each row to Notion, keeping a bounded window of requests in flight
+    auto &stats = NotionStats::Get();
+    auto serialize_start = std::chrono::steady_clock::now();
+    lstate.serializer.SetChunk(input);
+    stats.Record(NotionStatPhase::SERIALIZE, NotionStats::ElapsedMicros(serialize_start));
     for (idx_t row_idx = 0; row_idx < input.size(); row_idx++) {
-        std::string properties = RowToNotionProperties(column_names, column_types, input, row_idx);
+        const NotionExistingPage *existing = nullptr;
+        if (bind_data.upsert) {
+            std::string key;
+            const auto &key_type =
+                bind_data.target_columns[bind_data.target_column_ids[bind_data.key_column]].logical_type;
+            if (GetKeyString(input.GetValue(bind_data.key_column, row_idx), key_type, key)) {
+                std::lock_guard<std::mutex> guard(gstate.lock);
+                if (!gstate.copied_keys.insert(key).second) {
+                    // A second row with the key would create a second page, or race the first update
+                    gstate.rows_failed++;
+                    if (gstate.errors.size() < MAX_REPORTED_ERRORS) {
+                        gstate.errors.push_back("Duplicate KEY value \"" + key + "\": each key can be copied once");
+                    }
+                    continue;
+                }
+                auto entry = gstate.existing_pages.find(key);
+                if (entry != gstate.existing_pages.end()) {
+                    existing = &entry->second;
+                }
+            }
+            if (existing && !RowChanged(lstate, *existing, row_idx)) {
+                std::lock_guard<std::mutex> guard(gstate.lock);
+                gstate.rows_unchanged++;
+                continue;
+            }
+        }
 
-        auto response = NotionRequests::CreatePage(bind_data.database_id,
-                                                   bind_data.auth_token,
-                                                   properties);
+        serialize_start = std::chrono::steady_clock::now();
+        std::string properties;
+        properties.reserve(lstate.properties_size);
+        lstate.serializer.Serialize(row_idx, properties);
+        lstate.properties_size = properties.size();
+        stats.Record(NotionStatPhase::SERIALIZE, NotionStats::ElapsedMicros(serialize_start));
 
-        if (!response.success) {
-            throw IOException("Failed to write row to Notion: " + response.body);
+        DrainRequests(gstate, lstate, bind_data.max_in_flight - 1);
+        // Requests are paced by the rate limiter of the auth token
+        if (existing) {
+            lstate.in_flight.push_back(
+                NotionRequests::UpdatePageAsync(existing->page_id, bind_data.auth_token, properties));
+        } else {
+            lstate.in_flight.push_back(
+                NotionRequests::CreatePageAsync(bind_data.database_id, bind_data.auth_token, properties));
         }
-
-        gstate.rows_written++;
     }
 }
 
+static void NotionCopyCombine(ExecutionContext &context, FunctionData &bind_data_p, GlobalFunctionData &gstate_p,
+                              LocalFunctionData &lstate_p) {
+    auto &gstate = gstate_p.Cast<NotionCopyGlobalState>();
+    auto &lstate = lstate_p.Cast<NotionCopyLocalState>();
+    DrainRequests(gstate, lstate, 0);
+}
+
 static void NotionCopyFinalize(ClientContext &context, FunctionData &bind_data_p, GlobalFunctionData &gstate_p) {
     auto &gstate = gstate_p.Cast<NotionCopyGlobalState>();
-    // Could log the number of rows written here
+    if (gstate.rows_failed == 0) {
+        return;
+    }
+
+    std::string message = "Wrote " + std::to_string(gstate.rows_written) + " rows to Notion";
+    if (gstate.rows_unchanged > 0) {
+        message += " (" + std::to_string(gstate.rows_unchanged) + " unchanged rows skipped)";
+    }
+    message += ", but " + std::to_string(gstate.rows_failed) + " rows failed. First errors:";
+    for (const auto &error : gstate.errors) {
+        message += "\n" + error;
+    }
+    throw IOException(message);
+}
+
+static CopyFunctionExecutionMode NotionCopyExecutionMode(bool preserve_insertion_order, bool supports_batch_index) {
+    // Notion databases have no insertion order to preserve, so every thread can sink rows
+    return CopyFunctionExecutionMode::PARALLEL_COPY_TO_FILE;
 }
 
 void NotionWrite::RegisterCopyFunction(DatabaseInstance &db) {
     CopyFunction notion_copy("notion");
     notion_copy.copy_to_bind = NotionCopyBind;
-    notion_copy.copy_to_initialize_global = NotionCopyInit;
+    notion_copy.copy_to_initialize_global = NotionCopyInitGlobal;
+    notion_copy.copy_to_initialize_local = NotionCopyInitLocal;
     notion_copy.copy_to_sink = NotionCopySink;
+    notion_copy.copy_to_combine = NotionCopyCombine;
     notion_copy.copy_to_finalize = NotionCopyFinalize;
+    notion_copy.execution_mode = NotionCopyExecutionMode;
 
     notion_copy.extension = "notion";
 
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Throughput and latency benchmark of read_notion scans and COPY TO notion writes.
+
+Starts the mock Notion server with a synthetic database of ROWS pages x PROPERTIES properties,
+runs the scans and the copy with the DuckDB shell built with the extension, and reports rows per
+second along with the p50/p99 request latency measured by notion_stats().
+
+    python3 test/benchmark/notion_benchmark.py --duckdb build/release/duckdb \\
+        --rows 10000 --properties 20 --latency-ms 50 --partitions 1,4
+"""
+
+import argparse
+import json
+import os
+import socket
+import subprocess
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+MOCK_SERVER = os.path.join(ROOT, "test", "mock", "notion_mock_server.py")
+SYNTHETIC_DB = "99999999999999999999999999999999"
+COPY_DB = "33333333333333333333333333333333"
+CONTROL_DB = "44444444444444444444444444444444"
+
+
+def free_port():
+    with socket.socket() as sock:
+        sock.bind(("127.0.0.1", 0))
+        return sock.getsockname()[1]
+
+
+def start_mock(options, port):
+    command = [sys.executable, MOCK_SERVER, "--port", str(port), "--latency-ms", str(options.latency_ms),
+               "--page-size", str(options.page_size), "--rate-limit-every", str(options.rate_limit_every),
+               "--synthetic", "%dx%d" % (options.rows, options.properties)]
+    server = subprocess.Popen(command, stdout=subprocess.PIPE, text=True)
+    # The server prints its address once it listens
+    server.stdout.readline()
+    return server
+
+
+def run_sql(options, statements):
+    result = subprocess.run([options.duckdb, "-json", "-c", ";\n".join(statements) + ";"], capture_output=True,
+                            text=True)
+    if result.returncode != 0:
+        raise RuntimeError(result.stderr.strip() or result.stdout.strip())
+    # The shell prints one JSON array per statement with results; the last one is the report
+    output = result.stdout.strip()
+    return json.loads(output[output.rfind("\n[") + 1:] if "\n[" in output else output)
+
+
+def setup_statements(base_url, options):
+    return [
+        "SET GLOBAL notion_api_base_url = '%s'" % base_url,
+        "SET GLOBAL notion_requests_per_second = %s" % options.requests_per_second,
+        "CREATE SECRET notion_mock (TYPE notion, TOKEN 'benchmark-token')",
+        "CREATE TEMPORARY TABLE marks (name VARCHAR, ts TIMESTAMP WITH TIME ZONE)",
+    ]
+
+
+def report_statement(endpoint, rows):
+    # Statements run in their own transaction, so now() marks the end of the previous one
+    return ("SELECT %d / epoch(max(ts) FILTER (name = 'end') - max(ts) FILTER (name = 'start')) AS rows_per_second, "
+            "(SELECT sum(count) FROM notion_stats() WHERE category = 'request' AND name = '%s') AS requests, "
+            "(SELECT max(p50_ms) FROM notion_stats() WHERE category = 'request' AND name = '%s') AS p50_ms, "
+            "(SELECT max(p99_ms) FROM notion_stats() WHERE category = 'request' AND name = '%s') AS p99_ms, "
+            "(SELECT sum(count) FROM notion_stats() WHERE category = 'request' AND retries > 0) AS retried "
+            "FROM marks" % (rows, endpoint, endpoint, endpoint))
+
+
+def benchmark_scan(options, base_url, partitions):
+    statements = setup_statements(base_url, options) + [
+        "SET notion_scan_partitions = %d" % partitions,
+        # Bind once so the schema request is not measured
+        "SELECT * FROM read_notion('%s') LIMIT 0" % SYNTHETIC_DB,
+        "SELECT * FROM notion_stats_reset()",
+        "INSERT INTO marks VALUES ('start', now())",
+        "CREATE TEMPORARY TABLE scanned AS SELECT * FROM read_notion('%s')" % SYNTHETIC_DB,
+        "INSERT INTO marks VALUES ('end', now())",
+        report_statement("POST /v1/databases/{id}/query", options.rows),
+    ]
+    return run_sql(options, statements)[0]
+
+
+def benchmark_copy(options, base_url):
+    rows = options.copy_rows
+    statements = setup_statements(base_url, options) + [
+        "SET notion_copy_concurrency = %d" % options.copy_concurrency,
+        "COPY (SELECT 'reset' AS \"Command\") TO '%s' (FORMAT notion)" % CONTROL_DB,
+        "CREATE TEMPORARY TABLE rows AS SELECT 'row ' || i AS \"Name\", i::DOUBLE AS \"Amount\", "
+        "i % 2 = 0 AS \"Done\" FROM range(%d) t(i)" % rows,
+        "SELECT * FROM notion_stats_reset()",
+        "INSERT INTO marks VALUES ('start', now())",
+        "COPY rows TO '%s' (FORMAT notion)" % COPY_DB,
+        "INSERT INTO marks VALUES ('end', now())",
+        report_statement("POST /v1/pages", rows),
+    ]
+    return run_sql(options, statements)[0]
+
+
+def print_result(name, result):
+    print("%-22s %12.0f %9d %9.1f %9.1f %8d" % (name, result["rows_per_second"] or 0, result["requests"] or 0,
+                                                result["p50_ms"] or 0, result["p99_ms"] or 0, result["retried"] or 0))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark read_notion and COPY TO notion against the mock server")
+    parser.add_argument("--duckdb", default=os.path.join(ROOT, "build", "release", "duckdb"),
+                        help="DuckDB shell built with the extension")
+    parser.add_argument("--rows", type=int, default=10000, help="pages of the synthetic database")
+    parser.add_argument("--properties", type=int, default=20, help="properties of the synthetic database")
+    parser.add_argument("--latency-ms", type=float, default=50, help="latency the mock adds to every response")
+    parser.add_argument("--page-size", type=int, default=100, help="results per query page")
+    parser.add_argument("--rate-limit-every", type=int, default=0, help="answer every Nth request with 429")
+    parser.add_argument("--requests-per-second", type=float, default=0, help="notion_requests_per_second")
+    parser.add_argument("--partitions", default="1,4", help="notion_scan_partitions values to compare")
+    parser.add_argument("--copy-rows", type=int, default=1000, help="rows written by the COPY benchmark")
+    parser.add_argument("--copy-concurrency", type=int, default=8, help="notion_copy_concurrency")
+    options = parser.parse_args()
+
+    port = free_port()
+    server = start_mock(options, port)
+    base_url = "http://127.0.0.1:%d/v1" % port
+    try:
+        print("%d rows x %d properties, %g ms latency, page size %d" %
+              (options.rows, options.properties, options.latency_ms, options.page_size))
+        print("%-22s %12s %9s %9s %9s %8s" % ("benchmark", "rows/s", "requests", "p50 ms", "p99 ms", "retried"))
+        for partitions in [int(value) for value in options.partitions.split(",")]:
+            print_result("scan, %d partition(s)" % partitions, benchmark_scan(options, base_url, partitions))
+        print_result("copy, %d in flight" % options.copy_concurrency, benchmark_copy(options, base_url))
+    finally:
+        server.terminate()
+        server.wait()
+
+
+if __name__ == "__main__":
+    main()
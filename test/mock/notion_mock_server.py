@@ -0,0 +1,589 @@
+#!/usr/bin/env python3
+"""Local mock of the Notion API endpoints used by the extension.
+
+Serves a few fixture databases (and optionally a synthetic one for benchmarks) from memory:
+
+    GET   /v1/databases/{id}             database schema
+    GET   /v1/data_sources?database_id=  data sources of a database
+    POST  /v1/databases/{id}/query       filter, sorts, filter_properties, pagination
+    GET   /v1/pages/{id}                 a page
+    POST  /v1/pages                      create a page
+    PATCH /v1/pages/{id}                 update a page
+    POST  /v1/search                     databases of the workspace
+    GET   /v1/blocks/{id}/children       blocks of a page
+
+Query filters are evaluated, so a filter the extension pushes down wrongly changes the result.
+Responses rotate between Content-Length, gzip, chunked, chunked gzip and close-delimited bodies so
+every test exercises each framing of the HTTP parser.
+
+Pages created in the control database run their title as a command, which lets SQL tests change
+the state of the server:
+
+    reset                                  restore the fixtures
+    archive <page_id>                      archive a page
+    add_property <database_id> <name> <type>
+    rate_limit <N>                         answer every Nth request with 429 (0 turns it off)
+
+Usage: notion_mock_server.py [--port 8765] [--latency-ms 0] [--page-size 100]
+                             [--rate-limit-every N] [--synthetic ROWSxPROPS]
+"""
+
+import argparse
+import datetime
+import gzip
+import itertools
+import json
+import re
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+TASKS_DB = "11111111111111111111111111111111"
+TEAM_DB = "22222222222222222222222222222222"
+COPY_DB = "33333333333333333333333333333333"
+CONTROL_DB = "44444444444444444444444444444444"
+SYNC_DB = "55555555555555555555555555555555"
+SYNTHETIC_DB = "99999999999999999999999999999999"
+
+TASK_ROWS = 450
+TEAM_ROWS = 30
+SYNC_ROWS = 120
+
+EPOCH = datetime.datetime(2024, 1, 1, tzinfo=datetime.timezone.utc)
+USERS = [("a0000000-0000-4000-8000-000000000001", "Ada"), ("a0000000-0000-4000-8000-000000000002", "Grace")]
+STATUSES = ["Not started", "In progress", "Done"]
+TAGS = ["red", "green", "blue"]
+
+
+def iso(moment):
+    return moment.strftime("%Y-%m-%dT%H:%M:%S.000Z")
+
+
+def page_id(database_id, row):
+    return "%s-0000-4000-8000-%012d" % (database_id[:8], row)
+
+
+def property_schema(name, type_name, options=None):
+    schema = {"id": re.sub(r"[^a-z0-9]", "", name.lower())[:4] or "prop", "name": name, "type": type_name,
+              type_name: {}}
+    if options is not None:
+        schema[type_name] = {"options": [{"name": option} for option in options]}
+    if type_name == "title":
+        schema["id"] = "title"
+    return schema
+
+
+class Database:
+    def __init__(self, database_id, title, properties):
+        self.id = database_id
+        self.title = title
+        self.properties = {schema["name"]: schema for schema in properties}
+        self.pages = []
+
+    def add_page(self, row, values, created):
+        self.pages.append({
+            "id": page_id(self.id, row),
+            "created_time": iso(created),
+            "last_edited_time": iso(created + datetime.timedelta(hours=1)),
+            "archived": False,
+            "values": values,
+        })
+
+
+def task_values(row):
+    """Values of a row of the tasks database; see test/sql for the expected aggregates."""
+    return {
+        "Name": "Task %d" % row,
+        "Points": None if row % 17 == 0 else float(row % 10),
+        "Done": row % 3 == 0,
+        "Status": STATUSES[row % 3],
+        "Tags": [TAGS[i] for i in range(3) if (row >> i) & 1],
+        "Due": None if row % 11 == 0 else (EPOCH + datetime.timedelta(days=row)).strftime("%Y-%m-%d"),
+        "Owner": [USERS[row % 2][0]],
+        "Notes": "note \"%d\"\nline" % row if row % 5 == 0 else "",
+    }
+
+
+def build_fixtures(synthetic):
+    databases = {}
+    task_properties = [
+        property_schema("Name", "title"),
+        property_schema("Points", "number"),
+        property_schema("Done", "checkbox"),
+        property_schema("Status", "status", STATUSES),
+        property_schema("Tags", "multi_select", TAGS),
+        property_schema("Due", "date"),
+        property_schema("Owner", "people"),
+        property_schema("Notes", "rich_text"),
+    ]
+    tasks = Database(TASKS_DB, "Tasks", task_properties)
+    for row in range(TASK_ROWS):
+        tasks.add_page(row, task_values(row), EPOCH + datetime.timedelta(minutes=37 * row))
+    databases[tasks.id] = tasks
+
+    team = Database(TEAM_DB, "Team tasks", task_properties[:4] + [property_schema("Team", "select", ["core", "web"])])
+    for row in range(TEAM_ROWS):
+        values = task_values(row)
+        values["Team"] = "core" if row % 2 == 0 else "web"
+        team.add_page(row, {name: values[name] for name in team.properties},
+                      EPOCH + datetime.timedelta(minutes=11 * row))
+    databases[team.id] = team
+
+    databases[COPY_DB] = Database(COPY_DB, "Imports", [
+        property_schema("Name", "title"),
+        property_schema("Amount", "number"),
+        property_schema("Done", "checkbox"),
+        property_schema("Category", "select", ["a", "b"]),
+        property_schema("Owner", "people"),
+    ])
+    databases[CONTROL_DB] = Database(CONTROL_DB, "Mock control", [property_schema("Command", "title")])
+
+    sync = Database(SYNC_DB, "Sync source", task_properties[:4])
+    for row in range(SYNC_ROWS):
+        values = task_values(row)
+        sync.add_page(row, {name: values[name] for name in sync.properties},
+                      EPOCH + datetime.timedelta(minutes=5 * row))
+    databases[sync.id] = sync
+
+    if synthetic:
+        rows, columns = synthetic
+        properties = [property_schema("Name", "title")]
+        kinds = ["number", "rich_text", "checkbox", "select", "date"]
+        for i in range(1, columns):
+            kind = kinds[i % len(kinds)]
+            properties.append(property_schema("P%d" % i, kind, TAGS if kind == "select" else None))
+        bench = Database(SYNTHETIC_DB, "Synthetic", properties)
+        for row in range(rows):
+            values = {"Name": "Row %d" % row}
+            for i in range(1, columns):
+                kind = kinds[i % len(kinds)]
+                values["P%d" % i] = {
+                    "number": float(row * i % 1000),
+                    "rich_text": "text %d %d" % (row, i),
+                    "checkbox": (row + i) % 2 == 0,
+                    "select": TAGS[(row + i) % 3],
+                    "date": (EPOCH + datetime.timedelta(days=row % 365)).strftime("%Y-%m-%d"),
+                }[kind]
+            bench.add_page(row, values, EPOCH + datetime.timedelta(seconds=30 * row))
+        databases[bench.id] = bench
+    return databases
+
+
+def rich_text(text):
+    if not text:
+        return []
+    return [{"type": "text", "text": {"content": text, "link": None}, "plain_text": text, "href": None}]
+
+
+def render_value(type_name, value):
+    if type_name in ("title", "rich_text"):
+        return rich_text(value)
+    if type_name in ("select", "status"):
+        return None if value is None else {"id": value[:4], "name": value, "color": "default"}
+    if type_name == "multi_select":
+        return [{"id": name[:4], "name": name, "color": "default"} for name in value or []]
+    if type_name == "date":
+        return None if value is None else {"start": value, "end": None, "time_zone": None}
+    if type_name == "people":
+        names = dict(USERS)
+        return [{"object": "user", "id": user, "name": names.get(user, user)} for user in value or []]
+    if type_name == "relation":
+        return [{"id": related} for related in value or []]
+    if type_name == "checkbox":
+        return bool(value)
+    return value
+
+
+def render_page(database, page, property_filter=None):
+    properties = {}
+    for name, schema in database.properties.items():
+        if property_filter is not None and schema["id"] not in property_filter and name not in property_filter:
+            continue
+        type_name = schema["type"]
+        properties[name] = {"id": schema["id"], "type": type_name,
+                            type_name: render_value(type_name, page["values"].get(name))}
+    return {
+        "object": "page",
+        "id": page["id"],
+        "created_time": page["created_time"],
+        "last_edited_time": page["last_edited_time"],
+        "created_by": {"object": "user", "id": USERS[0][0]},
+        "last_edited_by": {"object": "user", "id": USERS[0][0]},
+        "archived": page["archived"],
+        "in_trash": page["archived"],
+        "parent": {"type": "database_id", "database_id": database.id},
+        "properties": properties,
+        "url": "https://www.notion.so/" + page["id"].replace("-", ""),
+    }
+
+
+def render_database(database):
+    return {
+        "object": "database",
+        "id": database.id,
+        "title": rich_text(database.title),
+        "archived": False,
+        "in_trash": False,
+        "properties": database.properties,
+        "data_sources": [{"id": database.id, "name": database.title}],
+    }
+
+
+def plain_value(page, type_name, name):
+    value = page["values"].get(name)
+    if type_name == "checkbox":
+        return bool(value)
+    return value
+
+
+def compare_dates(value, operand):
+    # Date operands without a time compare by day
+    if len(operand) == 10:
+        return (value[:10] > operand[:10]) - (value[:10] < operand[:10])
+    left = datetime.datetime.fromisoformat(value.replace("Z", "+00:00"))
+    if len(value) == 10:
+        left = left.replace(tzinfo=datetime.timezone.utc)
+    right = datetime.datetime.fromisoformat(operand.replace("Z", "+00:00"))
+    return (left > right) - (left < right)
+
+
+def matches_condition(value, type_name, condition):
+    for operation, operand in condition.items():
+        empty = value is None or value == "" or value == []
+        if operation == "is_empty":
+            result = empty
+        elif operation == "is_not_empty":
+            result = not empty
+        elif type_name in ("date", "created_time", "last_edited_time"):
+            if empty:
+                return False
+            order = compare_dates(value, operand)
+            result = {"equals": order == 0, "before": order < 0, "after": order > 0,
+                      "on_or_before": order <= 0, "on_or_after": order >= 0}[operation]
+        elif operation == "contains":
+            result = operand in value if isinstance(value, list) else (value is not None and operand in value)
+        elif operation == "does_not_contain":
+            result = not (operand in value if isinstance(value, list) else (value is not None and operand in value))
+        elif operation == "equals":
+            result = value == operand
+        elif operation == "does_not_equal":
+            result = value != operand
+        elif value is None:
+            return False
+        else:
+            result = {"greater_than": value > operand, "less_than": value < operand,
+                      "greater_than_or_equal_to": value >= operand,
+                      "less_than_or_equal_to": value <= operand,
+                      "starts_with": str(value).startswith(str(operand)),
+                      "ends_with": str(value).endswith(str(operand))}.get(operation, True)
+        if not result:
+            return False
+    return True
+
+
+def matches(database, page, condition):
+    if "and" in condition:
+        return all(matches(database, page, child) for child in condition["and"])
+    if "or" in condition:
+        return any(matches(database, page, child) for child in condition["or"])
+    if "timestamp" in condition:
+        field = condition["timestamp"]
+        return matches_condition(page[field], field, condition[field])
+    schema = database.properties.get(condition.get("property"))
+    if schema is None:
+        raise ValueError("Could not find property with name or id: %s" % condition.get("property"))
+    type_name = schema["type"]
+    if type_name not in condition:
+        raise ValueError("Filter type %s does not match property type %s" % (list(condition), type_name))
+    return matches_condition(plain_value(page, type_name, schema["name"]), type_name, condition[type_name])
+
+
+def parse_value(schema, value):
+    type_name = schema["type"]
+    if type_name in ("title", "rich_text"):
+        return "".join(piece.get("text", {}).get("content", "") for piece in value or [])
+    if type_name in ("select", "status"):
+        if value is None:
+            return None
+        options = schema[type_name].setdefault("options", [])
+        if type_name == "select" and value["name"] not in [option["name"] for option in options]:
+            # Writing an unknown select option adds it to the database
+            options.append({"name": value["name"]})
+        return value["name"]
+    if type_name == "multi_select":
+        return [option["name"] for option in value or []]
+    if type_name == "date":
+        return None if value is None else value["start"]
+    if type_name in ("people", "relation"):
+        return [entry["id"] for entry in value or []]
+    return value
+
+
+class MockNotion:
+    def __init__(self, options):
+        self.options = options
+        self.lock = threading.Lock()
+        self.databases = build_fixtures(options.synthetic)
+        self.request_count = 0
+        self.framing = itertools.cycle(["length", "gzip", "chunked", "chunked_gzip", "close"])
+
+    def find_page(self, identifier):
+        identifier = identifier.replace("-", "")
+        for database in self.databases.values():
+            for page in database.pages:
+                if page["id"].replace("-", "") == identifier:
+                    return database, page
+        return None, None
+
+    def database(self, identifier):
+        database = self.databases.get(identifier.replace("-", ""))
+        if database is None:
+            raise NotFound("Could not find database with ID: %s." % identifier)
+        return database
+
+    def run_command(self, command):
+        words = command.split()
+        if not words:
+            return
+        if words[0] == "reset":
+            self.databases = build_fixtures(self.options.synthetic)
+        elif words[0] == "archive":
+            _, page = self.find_page(words[1])
+            if page is None:
+                raise NotFound("Could not find page with ID: %s." % words[1])
+            page["archived"] = True
+        elif words[0] == "add_property":
+            self.database(words[1]).properties[words[2]] = property_schema(words[2], words[3])
+        elif words[0] == "rate_limit":
+            self.options.rate_limit_every = int(words[1])
+        else:
+            raise ValueError("Unknown mock command: %s" % command)
+
+    def query(self, database_id, body, property_filter):
+        database = self.database(database_id)
+        pages = [page for page in database.pages if not page["archived"]]
+        if body.get("filter"):
+            pages = [page for page in pages if matches(database, page, body["filter"])]
+        for sort in reversed(body.get("sorts") or []):
+            field = sort.get("timestamp")
+            key = (lambda page: page[field]) if field else (lambda page: page["values"].get(sort["property"]) or "")
+            pages.sort(key=key, reverse=sort.get("direction") == "descending")
+        page_size = min(int(body.get("page_size") or 100), 100, self.options.page_size)
+        start = int(body.get("start_cursor") or 0)
+        results = pages[start:start + page_size]
+        has_more = start + page_size < len(pages)
+        return {
+            "object": "list",
+            "results": [render_page(database, page, property_filter) for page in results],
+            "next_cursor": str(start + page_size) if has_more else None,
+            "has_more": has_more,
+            "type": "page_or_database",
+        }
+
+    def create_page(self, body):
+        database = self.database(body["parent"]["database_id"])
+        values = {}
+        for name, value in body.get("properties", {}).items():
+            schema = database.properties.get(name)
+            if schema is None:
+                raise ValueError("%s is not a property that exists." % name)
+            values[name] = parse_value(schema, value[schema["type"]])
+        if database.id == CONTROL_DB:
+            self.run_command(values.get("Command", ""))
+            database = self.databases[CONTROL_DB]
+        now = datetime.datetime.now(datetime.timezone.utc)
+        row = len(database.pages) + 1000000
+        database.pages.append({"id": page_id(database.id, row), "created_time": iso(now),
+                               "last_edited_time": iso(now), "archived": False, "values": values})
+        return render_page(database, database.pages[-1])
+
+    def update_page(self, identifier, body):
+        database, page = self.find_page(identifier)
+        if page is None:
+            raise NotFound("Could not find page with ID: %s." % identifier)
+        for name, value in body.get("properties", {}).items():
+            schema = database.properties.get(name)
+            if schema is None:
+                raise ValueError("%s is not a property that exists." % name)
+            page["values"][name] = parse_value(schema, value[schema["type"]])
+        page["last_edited_time"] = iso(datetime.datetime.now(datetime.timezone.utc))
+        return render_page(database, page)
+
+    def search(self):
+        results = []
+        for database in self.databases.values():
+            result = render_database(database)
+            result["object"] = "data_source"
+            result["parent"] = {"type": "database_id", "database_id": database.id}
+            results.append(result)
+        return {"object": "list", "results": results, "next_cursor": None, "has_more": False}
+
+    def block_children(self, identifier):
+        database, page = self.find_page(identifier)
+        if page is None:
+            raise NotFound("Could not find block with ID: %s." % identifier)
+        title = next((page["values"].get(name) for name, schema in database.properties.items()
+                      if schema["type"] == "title"), "")
+        block = {"object": "block", "id": page["id"][:-4] + "b001", "type": "paragraph", "has_children": False,
+                 "parent": {"type": "page_id", "page_id": page["id"]},
+                 "paragraph": {"rich_text": rich_text(title or "")}}
+        return {"object": "list", "results": [block], "next_cursor": None, "has_more": False}
+
+
+class NotFound(Exception):
+    pass
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    server_version = "NotionMock/1.0"
+
+    def log_message(self, format, *args):
+        if self.server.mock.options.verbose:
+            sys.stderr.write("%s %s\n" % (self.command, format % args))
+
+    def do_GET(self):
+        self.handle_request()
+
+    def do_POST(self):
+        self.handle_request()
+
+    def do_PATCH(self):
+        self.handle_request()
+
+    def handle_request(self):
+        mock = self.server.mock
+        length = int(self.headers.get("Content-Length") or 0)
+        raw_body = self.rfile.read(length) if length else b""
+        if mock.options.latency_ms:
+            time.sleep(mock.options.latency_ms / 1000.0)
+        # Commands are never throttled, so a test can always turn the rate limit off again
+        is_command = CONTROL_DB.encode() in raw_body
+        with mock.lock:
+            mock.request_count += 1
+            throttled = (not is_command and mock.options.rate_limit_every and
+                         mock.request_count % mock.options.rate_limit_every == 0)
+            framing = next(mock.framing)
+        if throttled:
+            self.send_json(429, {"object": "error", "status": 429, "code": "rate_limited",
+                                 "message": "You have been rate limited."}, framing,
+                           {"Retry-After": str(mock.options.retry_after)})
+            return
+        if not self.headers.get("Authorization", "").startswith("Bearer "):
+            self.send_json(401, {"object": "error", "status": 401, "code": "unauthorized",
+                                 "message": "API token is invalid."}, framing)
+            return
+        try:
+            body = json.loads(raw_body) if raw_body else {}
+            with mock.lock:
+                status, response = 200, self.route(mock, body)
+        except NotFound as error:
+            status, response = 404, {"object": "error", "status": 404, "code": "object_not_found",
+                                     "message": str(error)}
+        except (ValueError, KeyError, TypeError) as error:
+            status, response = 400, {"object": "error", "status": 400, "code": "validation_error",
+                                     "message": str(error)}
+        self.send_json(status, response, framing)
+
+    def route(self, mock, body):
+        path, _, query_string = self.path.partition("?")
+        query = {}
+        for pair in query_string.split("&") if query_string else []:
+            key, _, value = pair.partition("=")
+            query.setdefault(key, []).append(value.replace("%20", " "))
+        parts = [part for part in path.split("/") if part]
+        if parts and parts[0] == "v1":
+            parts = parts[1:]
+        method = self.command
+        if method == "GET" and len(parts) == 2 and parts[0] == "databases":
+            return render_database(mock.database(parts[1]))
+        if method == "GET" and parts == ["data_sources"]:
+            database = mock.database(query.get("database_id", [""])[0])
+            return {"object": "list", "results": [render_database(database)], "has_more": False}
+        if method == "POST" and len(parts) == 3 and parts[0] == "databases" and parts[2] == "query":
+            return mock.query(parts[1], body, query.get("filter_properties"))
+        if method == "GET" and len(parts) == 2 and parts[0] == "pages":
+            database, page = mock.find_page(parts[1])
+            if page is None:
+                raise NotFound("Could not find page with ID: %s." % parts[1])
+            return render_page(database, page, query.get("filter_properties"))
+        if method == "POST" and parts == ["pages"]:
+            return mock.create_page(body)
+        if method == "PATCH" and len(parts) == 2 and parts[0] == "pages":
+            return mock.update_page(parts[1], body)
+        if method == "POST" and parts == ["search"]:
+            return mock.search()
+        if method == "GET" and len(parts) == 3 and parts[0] == "blocks" and parts[2] == "children":
+            return mock.block_children(parts[1])
+        raise NotFound("Invalid request URL: %s %s" % (method, self.path))
+
+    def send_json(self, status, response, framing, headers=None):
+        payload = json.dumps(response).encode()
+        if framing in ("gzip", "chunked_gzip"):
+            payload = gzip.compress(payload)
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json; charset=utf-8")
+        for name, value in (headers or {}).items():
+            self.send_header(name, value)
+        if framing in ("gzip", "chunked_gzip"):
+            self.send_header("Content-Encoding", "gzip")
+        if framing in ("chunked", "chunked_gzip"):
+            self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+            # Uneven chunk sizes, so chunk boundaries fall inside JSON tokens and escapes
+            offset = 0
+            for size in itertools.cycle([1, 7, 300, 4096]):
+                if offset >= len(payload):
+                    break
+                chunk = payload[offset:offset + size]
+                self.wfile.write(b"%x\r\n%s\r\n" % (len(chunk), chunk))
+                offset += size
+            self.wfile.write(b"0\r\n\r\n")
+        elif framing == "close":
+            # No length: the body ends when the connection is closed
+            self.send_header("Connection", "close")
+            self.end_headers()
+            self.wfile.write(payload)
+            self.close_connection = True
+        else:
+            self.send_header("Content-Length", str(len(payload)))
+            self.end_headers()
+            self.wfile.write(payload)
+
+
+class Server(ThreadingHTTPServer):
+    daemon_threads = True
+    request_queue_size = 1024
+
+
+def parse_synthetic(text):
+    match = re.fullmatch(r"(\d+)x(\d+)", text or "")
+    if not match:
+        raise argparse.ArgumentTypeError("expected ROWSxPROPERTIES, e.g. 10000x20")
+    return int(match.group(1)), max(int(match.group(2)), 1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Mock Notion API server")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8765)
+    parser.add_argument("--latency-ms", type=float, default=0, help="delay added to every response")
+    parser.add_argument("--page-size", type=int, default=100, help="maximum results per query page")
+    parser.add_argument("--rate-limit-every", type=int, default=0, help="answer every Nth request with 429")
+    parser.add_argument("--retry-after", type=int, default=1, help="Retry-After seconds of injected 429s")
+    parser.add_argument("--synthetic", type=parse_synthetic, help="serve %s with ROWSxPROPERTIES" % SYNTHETIC_DB)
+    parser.add_argument("--verbose", action="store_true", help="log every request")
+    options = parser.parse_args()
+
+    server = Server((options.host, options.port), Handler)
+    server.mock = MockNotion(options)
+    print("Notion mock listening on http://%s:%d/v1" % (options.host, server.server_address[1]), flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()